@@ -0,0 +1,408 @@
+// End-to-end benchmark: generates databases with dbgen, then times the server binary
+// answering a fixed set of commands against each of them.
+// Results are written one JSON object per line.
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include "dbgen.h"
+
+struct Dataset {
+    std::string name;
+    GeneratorOptions options;
+};
+
+struct Query {
+    std::string name;
+    std::string sql;
+    long long expectedRows;     // lines of output | -1 when not checked
+    std::string expectedFirst;  // first line of output | empty when not checked
+    std::string input;          // statements fed on stdin when `sql` is "-"
+    std::string fewerPagesThan; // earlier query that must read more pages | empty when not checked
+};
+
+struct RunResult {
+    bool ok;
+    double ms;
+    long long rows;
+    std::string first;
+    long long pagesRead;        // as reported by `server --stats` | -1 when missing
+};
+
+static std::vector<Dataset> defaultDatasets(uint64_t rows) {
+    std::vector<Dataset> datasets;
+
+    Dataset base;
+    base.name = "utf8-4k";
+    base.options.rows = rows;
+    base.options.columns = parseColumnKinds("key,int,text,real,text");
+    base.options.indexes = {"key1"};
+    datasets.push_back(base);
+
+    Dataset noIndex = base;
+    noIndex.name = "utf8-4k-noindex";
+    noIndex.options.indexes.clear();
+    datasets.push_back(noIndex);
+
+    // UTF-16 index entries sort by their little / big-endian bytes, not like the UTF-8 the server works in
+    Dataset utf16 = base;
+    utf16.name = "utf16le-4k";
+    utf16.options.encoding = SQLiteEncoding::SQLITE_UTF16LE;
+    datasets.push_back(utf16);
+
+    Dataset utf16be = base;
+    utf16be.name = "utf16be-4k";
+    utf16be.options.encoding = SQLiteEncoding::SQLITE_UTF16BE;
+    datasets.push_back(utf16be);
+
+    // REAL columns holding numeric looking text, which must be printed as stored
+    Dataset realText = base;
+    realText.name = "real-text-4k";
+    realText.options.realTextEvery = 8;
+    realText.options.rows = std::max<uint64_t>(rows / 10, 1);
+    datasets.push_back(realText);
+
+    // small pages with reserved bytes and text that spills onto overflow pages
+    Dataset overflow = base;
+    overflow.name = "overflow-1k";
+    overflow.options.pageSize = 1024;
+    overflow.options.reservedBytes = 32;
+    overflow.options.textMin = 200;
+    overflow.options.textMax = 3000;
+    overflow.options.rows = std::max<uint64_t>(rows / 10, 1);
+    datasets.push_back(overflow);
+
+    // wide rows where a narrow index is much smaller than the table
+    Dataset wide = base;
+    wide.name = "wide-64k";
+    wide.options.pageSize = 65536;
+    wide.options.columns = parseColumnKinds("key,int,text,text,text,text,text,text,real");
+    wide.options.textMin = 32;
+    wide.options.textMax = 96;
+    datasets.push_back(wide);
+
+    return datasets;
+}
+
+static std::vector<Query> queriesFor(const Dataset& dataset) {
+    const GeneratorOptions& options = dataset.options;
+    const std::string& table = options.table;
+    // rowids in 1..rows with rowid % cardinality == k
+    auto keyRowsOf = [&](uint64_t k) -> long long {
+        return k == 0 ? options.rows / options.cardinality
+                      : (options.rows >= k ? (options.rows - k) / options.cardinality + 1 : 0);
+    };
+    uint64_t k = options.cardinality / 2;
+    std::string key = keyValue(k, options.cardinality);
+    long long keyRows = keyRowsOf(k);
+    // a key starting with a surrogate pair in UTF-16
+    uint64_t astral = std::min<uint64_t>(4, options.cardinality - 1);
+    std::string astralKey = keyValue(astral, options.cardinality);
+    uint64_t rowid = std::max<uint64_t>(options.rows / 2, 1);
+
+    // the same shapes with different literals in one process | exercises the plan cache
+    std::string keyLookups, rowidLookups;
+    for (unsigned i = 0; i < options.cardinality; i++) {
+        keyLookups += "SELECT id FROM " + table + " WHERE key1 = '" + keyValue(i, options.cardinality) + "'\n";
+    }
+    uint64_t seeks = std::min<uint64_t>(options.rows, 1000);
+    for (uint64_t i = 1; i <= seeks; i++) {
+        rowidLookups += "SELECT id, int1 FROM " + table + " WHERE id = " + std::to_string(i) + "\n";
+    }
+
+    // with an index, COUNT(*) and covering lookups never touch the wider table b-tree
+    std::string narrower = options.indexes.empty() ? "" : "scan";
+    std::string covered = options.indexes.empty() ? "" : "index_lookup";
+    return {
+        {"dbinfo", ".dbinfo", 2, "database page size: " + std::to_string(options.pageSize)},
+        {"tables", ".tables", 1, table},
+        {"scan", "SELECT id, int1 FROM " + table, static_cast<long long>(options.rows), ""},
+        {"scan_real", "SELECT id, real1 FROM " + table, static_cast<long long>(options.rows), ""},
+        {"count", "SELECT COUNT(*) FROM " + table, 1, std::to_string(options.rows), "", narrower},
+        {"count_filter", "SELECT COUNT(*) FROM " + table + " WHERE key1 = '" + key + "'", 1, std::to_string(keyRows)},
+        {"count_filter_astral", "SELECT COUNT(*) FROM " + table + " WHERE key1 = '" + astralKey + "'", 1,
+         std::to_string(keyRowsOf(astral))},
+        {"filter", "SELECT id FROM " + table + " WHERE int1 = 0", -1, ""},
+        {"index_lookup", "SELECT id, text1 FROM " + table + " WHERE key1 = '" + key + "'", keyRows, ""},
+        {"index_covering", "SELECT id, key1 FROM " + table + " WHERE key1 = '" + key + "'", keyRows, "", "", covered},
+        {"rowid_seek", "SELECT * FROM " + table + " WHERE id = " + std::to_string(rowid), options.rows ? 1 : 0, ""},
+        {"batch_index_lookup", "-", static_cast<long long>(options.rows), "", keyLookups},
+        {"batch_rowid_seek", "-", static_cast<long long>(seeks), "", rowidLookups},
+    };
+}
+
+// run `server --stats db sql` with `input` on stdin, counting the lines it prints
+// stderr goes to `errors`, where the pages read are picked up from
+static RunResult runServer(const std::string& server, const std::string& db, const std::string& sql,
+                           const std::string& input, const std::string& errors) {
+    RunResult result = {false, 0, 0, "", -1};
+    int fds[2];
+    if (pipe(fds) != 0) return result;
+
+    auto start = std::chrono::steady_clock::now();
+    pid_t pid = fork();
+    if (pid == 0) {
+        dup2(fds[1], STDOUT_FILENO);
+        int err = open(errors.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (err >= 0) dup2(err, STDERR_FILENO);
+        int in = open(input.empty() ? "/dev/null" : input.c_str(), O_RDONLY);
+        if (in >= 0) dup2(in, STDIN_FILENO);
+        close(fds[0]);
+        close(fds[1]);
+        execl(server.c_str(), server.c_str(), "--stats", db.c_str(), sql.c_str(), (char*)NULL);
+        _exit(127);
+    }
+    close(fds[1]);
+    if (pid < 0) {
+        close(fds[0]);
+        return result;
+    }
+
+    char buffer[65536];
+    ssize_t n;
+    bool firstLine = true;
+    while ((n = read(fds[0], buffer, sizeof(buffer))) > 0) {
+        for (ssize_t i = 0; i < n; i++) {
+            if (buffer[i] == '\n') {
+                result.rows++;
+                firstLine = false;
+            } else if (firstLine) {
+                result.first += buffer[i];
+            }
+        }
+    }
+    close(fds[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    result.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    result.ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+
+    std::ifstream errorFile(errors);
+    std::string line;
+    const std::string pagesRead = "pages read: ";
+    while (std::getline(errorFile, line)) {
+        if (line.compare(0, pagesRead.size(), pagesRead) == 0) result.pagesRead = std::stoll(line.substr(pagesRead.size()));
+    }
+    return result;
+}
+
+// read from `fd` until `lines` more lines arrived | false on EOF or after 10s without output
+static bool readLines(int fd, int lines, std::string& out) {
+    char c;
+    struct pollfd readable = {fd, POLLIN, 0};
+    while (lines != 0 && poll(&readable, 1, 10000) > 0 && read(fd, &c, 1) == 1) {
+        out += c;
+        if (c == '\n') lines--;
+    }
+    return lines == 0;
+}
+
+// a batch server keeps running a COUNT(*) while the database is rewritten with an index and
+// half the rows under a new schema cookie | stale plans would still scan the old table root
+static bool checkSchemaChange(const std::string& server, const std::string& workdir, const Dataset& dataset,
+                              double& ms) {
+    GeneratorOptions before = dataset.options;
+    before.indexes.clear();
+    GeneratorOptions after = dataset.options;
+    after.indexes = {"key1"};
+    after.rows = dataset.options.rows / 2;
+    after.schemaCookie = before.schemaCookie + 1;
+    std::string db = workdir + "/" + dataset.name + ".schema.db";
+    writeDatabase(db, before);
+
+    // keys repeat every `cardinality` rows starting at rowid 1
+    uint64_t k = 1 % dataset.options.cardinality;
+    std::string sql = "SELECT COUNT(*) FROM " + before.table + " WHERE key1 = '" + keyValue(k, before.cardinality) + "'\n";
+    auto expected = [&](uint64_t rows) {
+        long long n = k == 0 ? rows / before.cardinality : (rows >= k ? (rows - k) / before.cardinality + 1 : 0);
+        return std::to_string(n) + "\n";
+    };
+
+    int in[2], out[2];
+    if (pipe(in) != 0) return false;
+    if (pipe(out) != 0) {
+        close(in[0]);
+        close(in[1]);
+        return false;
+    }
+    auto start = std::chrono::steady_clock::now();
+    pid_t pid = fork();
+    if (pid == 0) {
+        dup2(in[0], STDIN_FILENO);
+        dup2(out[1], STDOUT_FILENO);
+        int err = open((db + ".stderr").c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (err >= 0) dup2(err, STDERR_FILENO);
+        close(in[0]);
+        close(in[1]);
+        close(out[0]);
+        close(out[1]);
+        execl(server.c_str(), server.c_str(), db.c_str(), "-", (char*)NULL);
+        _exit(127);
+    }
+    close(in[0]);
+    close(out[1]);
+    if (pid < 0) {
+        close(in[1]);
+        close(out[0]);
+        return false;
+    }
+
+    // twice per schema so the second statement reuses the first one's plan
+    std::string first, second, rest;
+    bool ok = write(in[1], (sql + sql).data(), sql.size() * 2) == static_cast<ssize_t>(sql.size() * 2) &&
+              readLines(out[0], 2, first);
+    if (ok) {
+        writeDatabase(db, after);
+        ok = write(in[1], (sql + sql).data(), sql.size() * 2) == static_cast<ssize_t>(sql.size() * 2) &&
+             readLines(out[0], 2, second);
+    }
+    // EOF on stdin ends the server | anything it still prints is unexpected
+    close(in[1]);
+    readLines(out[0], -1, rest);
+    close(out[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return ok && WIFEXITED(status) && WEXITSTATUS(status) == 0 && rest.empty() &&
+           first == expected(before.rows) + expected(before.rows) && second == expected(after.rows) + expected(after.rows);
+}
+
+static std::string jsonString(const std::string& str) {
+    std::string out = "\"";
+    for (char c : str) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out + "\"";
+}
+
+static const char* encodingName(SQLiteEncoding encoding) {
+    switch (encoding) {
+        case SQLiteEncoding::SQLITE_UTF16LE: return "utf16le";
+        case SQLiteEncoding::SQLITE_UTF16BE: return "utf16be";
+        default: return "utf8";
+    }
+}
+
+static void usage() {
+    std::cerr << "usage: bench [options]\n"
+                 "  --server PATH    server binary (server next to bench)\n"
+                 "  --rows N         rows per generated database (100000)\n"
+                 "  --repeat N       runs per query (5)\n"
+                 "  --workdir DIR    where generated databases are kept (bench_dbs)\n"
+                 "  --output FILE    JSON lines output (stdout)" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    std::string self = argv[0];
+    size_t slash = self.rfind('/');
+    std::string server = (slash == std::string::npos ? "." : self.substr(0, slash)) + "/server";
+    uint64_t rows = 100000;
+    int repeat = 5;
+    std::string workdir = "bench_dbs";
+    std::string outputPath;
+
+    for (int i = 1; i < argc; i++) {
+        std::string option = argv[i];
+        if (i + 1 >= argc) {
+            usage();
+            return 1;
+        }
+        std::string value = argv[++i];
+        if (option == "--server") server = value;
+        else if (option == "--rows") rows = std::stoull(value);
+        else if (option == "--repeat") repeat = std::max(1, std::stoi(value));
+        else if (option == "--workdir") workdir = value;
+        else if (option == "--output") outputPath = value;
+        else {
+            usage();
+            return 1;
+        }
+    }
+
+    std::ofstream outputFile;
+    if (!outputPath.empty()) outputFile.open(outputPath);
+    std::ostream& out = outputPath.empty() ? std::cout : outputFile;
+    mkdir(workdir.c_str(), 0755);
+
+    bool allOk = true;
+    for (const Dataset& dataset : defaultDatasets(rows)) {
+        std::string db = workdir + "/" + dataset.name + ".db";
+        auto start = std::chrono::steady_clock::now();
+        try {
+            writeDatabase(db, dataset.options);
+        } catch (const std::exception& e) {
+            std::cerr << dataset.name << ": " << e.what() << std::endl;
+            return 1;
+        }
+        double generateMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        struct stat info;
+        long long fileBytes = stat(db.c_str(), &info) == 0 ? info.st_size : -1;
+
+        std::string prefix = "{\"dataset\":" + jsonString(dataset.name) +
+                             ",\"page_size\":" + std::to_string(dataset.options.pageSize) +
+                             ",\"reserved\":" + std::to_string(dataset.options.reservedBytes) +
+                             ",\"encoding\":" + jsonString(encodingName(dataset.options.encoding)) +
+                             ",\"rows\":" + std::to_string(dataset.options.rows) +
+                             ",\"file_bytes\":" + std::to_string(fileBytes);
+        out << prefix << ",\"query\":\"generate\",\"ms\":" << generateMs << "}" << std::endl;
+
+        std::map<std::string, long long> pagesRead;
+        for (const Query& query : queriesFor(dataset)) {
+            std::string input;
+            if (!query.input.empty()) {
+                input = workdir + "/" + dataset.name + "." + query.name + ".sql";
+                std::ofstream(input) << query.input;
+            }
+            std::vector<double> times;
+            std::string errors = workdir + "/" + dataset.name + ".stderr";
+            RunResult last = {true, 0, 0, "", -1};
+            bool ok = true;
+            for (int r = 0; r < repeat; r++) {
+                last = runServer(server, db, query.sql, input, errors);
+                times.push_back(last.ms);
+                ok = ok && last.ok;
+            }
+            // the output is checked on the last run, every run must exit cleanly
+            if (query.expectedRows >= 0 && last.rows != query.expectedRows) ok = false;
+            if (!query.expectedFirst.empty() && last.first != query.expectedFirst) ok = false;
+            pagesRead[query.name] = last.pagesRead;
+            if (!query.fewerPagesThan.empty() &&
+                (last.pagesRead < 0 || last.pagesRead >= pagesRead[query.fewerPagesThan])) {
+                ok = false;
+            }
+            allOk = allOk && ok;
+
+            std::sort(times.begin(), times.end());
+            double mean = 0;
+            for (double t : times) mean += t;
+            mean /= times.size();
+            out << prefix << ",\"query\":" << jsonString(query.name) << ",\"sql\":" << jsonString(query.sql)
+                << ",\"repeat\":" << repeat << ",\"min_ms\":" << times.front()
+                << ",\"median_ms\":" << times[times.size() / 2] << ",\"mean_ms\":" << mean
+                << ",\"max_ms\":" << times.back() << ",\"output_rows\":" << last.rows
+                << ",\"pages_read\":" << last.pagesRead
+                << ",\"ok\":" << (ok ? "true" : "false") << "}" << std::endl;
+        }
+
+        double schemaMs = 0;
+        bool schemaOk = false;
+        try {
+            schemaOk = checkSchemaChange(server, workdir, dataset, schemaMs);
+        } catch (const std::exception& e) {
+            std::cerr << dataset.name << ": " << e.what() << std::endl;
+        }
+        allOk = allOk && schemaOk;
+        out << prefix << ",\"query\":\"schema_change\",\"ms\":" << schemaMs
+            << ",\"ok\":" << (schemaOk ? "true" : "false") << "}" << std::endl;
+    }
+    return allOk ? 0 : 2;
+}
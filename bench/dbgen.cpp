@@ -0,0 +1,597 @@
+#include "dbgen.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#define DATABASE_HEADER 100
+#define LEAF_HEADER 8
+#define INTERIOR_HEADER 12
+#define CELL_POINTER 2
+
+#define INTERIOR_INDEX_PAGE 0x02
+#define INTERIOR_TABLE_PAGE 0x05
+#define LEAF_INDEX_PAGE 0x0a
+#define LEAF_TABLE_PAGE 0x0d
+
+GeneratorOptions::GeneratorOptions()
+    : pageSize(4096), reservedBytes(0), rows(10000),
+      columns({ColumnKind::Key, ColumnKind::Int, ColumnKind::Text, ColumnKind::Real}),
+      textMin(8), textMax(32), cardinality(100), encoding(SQLiteEncoding::SQLITE_UTF8), seed(1),
+      table("bench"), schemaCookie(1), realTextEvery(0) {}
+
+std::vector<ColumnKind> parseColumnKinds(const std::string& spec) {
+    std::vector<ColumnKind> kinds;
+    std::stringstream ss(spec);
+    std::string token;
+    while (std::getline(ss, token, ',')) {
+        if (token == "key") kinds.push_back(ColumnKind::Key);
+        else if (token == "int") kinds.push_back(ColumnKind::Int);
+        else if (token == "real") kinds.push_back(ColumnKind::Real);
+        else if (token == "text") kinds.push_back(ColumnKind::Text);
+        else throw std::invalid_argument("Unknown column kind: " + token);
+    }
+    return kinds;
+}
+
+std::vector<std::string> columnNames(const GeneratorOptions& options) {
+    std::vector<std::string> names = {"id"};
+    int counts[4] = {0, 0, 0, 0};
+    const char* prefixes[4] = {"key", "int", "real", "text"};
+    for (ColumnKind kind : options.columns) {
+        int k = static_cast<int>(kind);
+        names.push_back(prefixes[k] + std::to_string(++counts[k]));
+    }
+    return names;
+}
+
+std::string keyValue(uint64_t rowid, unsigned cardinality) {
+    // prefixes whose UTF-16LE, UTF-16BE and UTF-8 byte orders all differ | U+1F600 is a surrogate pair
+    static const char* prefixes[] = {"k", "\u00e9", "\u0100", "\u4e2d", "\U0001f600", "\uff5a"};
+    uint64_t value = rowid % cardinality;
+    std::string digits = std::to_string(value);
+    size_t width = std::to_string(cardinality - 1).size();
+    return prefixes[value % 6] + std::string(width - digits.size(), '0') + digits;
+}
+
+// splitmix64 | deterministic for a given seed on every platform
+static uint64_t nextRandom(uint64_t& state) {
+    uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+static void appendVarint(std::string& out, uint64_t value) {
+    // 9th byte carries a full 8 bits
+    if (value > 0x00ffffffffffffffULL) {
+        char buffer[9];
+        buffer[8] = static_cast<char>(value & 0xff);
+        value >>= 8;
+        for (int i = 7; i >= 0; i--) {
+            buffer[i] = static_cast<char>((value & 0x7f) | 0x80);
+            value >>= 7;
+        }
+        out.append(buffer, 9);
+        return;
+    }
+    char buffer[9];
+    int n = 0;
+    do {
+        buffer[n++] = static_cast<char>(value & 0x7f);
+        value >>= 7;
+    } while (value != 0);
+    for (int i = n - 1; i >= 0; i--) out += static_cast<char>(buffer[i] | (i > 0 ? 0x80 : 0));
+}
+
+static size_t varintLength(uint64_t value) {
+    std::string buffer;
+    appendVarint(buffer, value);
+    return buffer.size();
+}
+
+static void put2(char* out, uint32_t value) {
+    out[0] = static_cast<char>(value >> 8);
+    out[1] = static_cast<char>(value);
+}
+
+static void put4(char* out, uint32_t value) {
+    out[0] = static_cast<char>(value >> 24);
+    out[1] = static_cast<char>(value >> 16);
+    out[2] = static_cast<char>(value >> 8);
+    out[3] = static_cast<char>(value);
+}
+
+// one value of a record, already encoded for the record body
+struct RecordValue {
+    uint64_t serialType;
+    std::string body;
+};
+
+static RecordValue integerValue(int64_t value) {
+    if (value == 0) return {8, ""};
+    if (value == 1) return {9, ""};
+    // smallest of 1, 2, 3, 4, 6, 8 bytes that holds the value
+    static const int widths[] = {1, 2, 3, 4, 6, 8};
+    static const uint64_t serialTypes[] = {1, 2, 3, 4, 5, 6};
+    int i = 0;
+    while (i < 5) {
+        int64_t limit = int64_t(1) << (widths[i] * 8 - 1);
+        if (value >= -limit && value < limit) break;
+        i++;
+    }
+    std::string body(widths[i], '\0');
+    uint64_t bits = static_cast<uint64_t>(value);
+    for (int b = widths[i] - 1; b >= 0; b--) {
+        body[b] = static_cast<char>(bits & 0xff);
+        bits >>= 8;
+    }
+    return {serialTypes[i], body};
+}
+
+static RecordValue realValue(double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    std::string body(8, '\0');
+    for (int b = 7; b >= 0; b--) {
+        body[b] = static_cast<char>(bits & 0xff);
+        bits >>= 8;
+    }
+    return {7, body};
+}
+
+// `text` is UTF-8 | re-encoded code point by code point for UTF-16 databases
+static RecordValue textValue(const std::string& text, SQLiteEncoding encoding) {
+    if (encoding == SQLiteEncoding::SQLITE_UTF8) return {13 + 2 * text.size(), text};
+    std::string body;
+    auto append = [&](uint32_t unit) {
+        if (encoding == SQLiteEncoding::SQLITE_UTF16LE) { body += static_cast<char>(unit & 0xff); body += static_cast<char>(unit >> 8); }
+        else { body += static_cast<char>(unit >> 8); body += static_cast<char>(unit & 0xff); }
+    };
+    for (size_t i = 0; i < text.size();) {
+        uint32_t codePoint = static_cast<unsigned char>(text[i++]);
+        int continuation = codePoint >= 0xf0 ? 3 : codePoint >= 0xe0 ? 2 : codePoint >= 0xc0 ? 1 : 0;
+        if (continuation) codePoint &= 0x3f >> continuation;
+        for (; continuation > 0 && i < text.size(); continuation--) {
+            codePoint = (codePoint << 6) | (static_cast<unsigned char>(text[i++]) & 0x3f);
+        }
+        if (codePoint >= 0x10000) {
+            append(0xd800 + ((codePoint - 0x10000) >> 10));
+            append(0xdc00 + ((codePoint - 0x10000) & 0x3ff));
+        } else {
+            append(codePoint);
+        }
+    }
+    return {13 + 2 * body.size(), body};
+}
+
+static RecordValue nullValue() {
+    return {0, ""};
+}
+
+static std::string encodeRecord(const std::vector<RecordValue>& values) {
+    std::string header;
+    for (const RecordValue& value : values) appendVarint(header, value.serialType);
+    // header size includes its own varint
+    size_t headerSize = header.size() + 1;
+    if (varintLength(headerSize) > 1) headerSize = header.size() + varintLength(header.size() + 2);
+    std::string record;
+    appendVarint(record, headerSize);
+    record += header;
+    for (const RecordValue& value : values) record += value.body;
+    return record;
+}
+
+// database pages are written straight to the file as soon as they are complete
+class PageWriter {
+public:
+    PageWriter(const std::string& path, const GeneratorOptions& options)
+        : file(path, std::ios::binary | std::ios::trunc), pageSize(options.pageSize),
+          usableSize(options.pageSize - options.reservedBytes), nextPage(2) {
+        if (!file) throw std::runtime_error("Failed to open " + path + " for writing.");
+    }
+
+    uint32_t allocate() {
+        return nextPage++;
+    }
+
+    uint32_t pageCount() const {
+        return nextPage - 1;
+    }
+
+    std::string blankPage() const {
+        return std::string(pageSize, '\0');
+    }
+
+    void write(uint32_t pageNo, const std::string& page) {
+        file.seekp(static_cast<std::streamoff>(pageNo - 1) * pageSize);
+        file.write(page.data(), pageSize);
+        if (!file) throw std::runtime_error("Failed to write page " + std::to_string(pageNo) + ".");
+    }
+
+    // split `payload` into the part kept on the b-tree page and an overflow chain
+    // returns the local part followed by the first overflow page number when it spills
+    std::string spill(const std::string& payload, bool tableLeaf) {
+        int64_t U = usableSize;
+        int64_t P = payload.size();
+        int64_t X = tableLeaf ? U - 35 : ((U - 12) * 64 / 255) - 23;
+        if (P <= X) return payload;
+        int64_t M = ((U - 12) * 32 / 255) - 23;
+        int64_t K = M + ((P - M) % (U - 4));
+        int64_t local = K <= X ? K : M;
+
+        uint32_t first = allocate();
+        uint32_t current = first;
+        size_t offset = local;
+        while (offset < payload.size()) {
+            size_t chunk = std::min<size_t>(U - 4, payload.size() - offset);
+            uint32_t next = offset + chunk < payload.size() ? allocate() : 0;
+            std::string page = blankPage();
+            put4(&page[0], next);
+            memcpy(&page[4], payload.data() + offset, chunk);
+            write(current, page);
+            offset += chunk;
+            current = next;
+        }
+        std::string cell = payload.substr(0, local);
+        char pointer[4];
+        put4(pointer, first);
+        cell.append(pointer, 4);
+        return cell;
+    }
+
+    std::ofstream file;
+    uint32_t pageSize;
+    uint32_t usableSize;
+
+private:
+    uint32_t nextPage;
+};
+
+// lay out a b-tree page | cells are given in key order and packed from the end of the usable area
+static std::string buildPage(PageWriter& writer, uint8_t type, const std::vector<std::string>& cells,
+                             uint32_t rightPointer, unsigned short headerOffset = 0) {
+    std::string page = writer.blankPage();
+    bool leaf = type == LEAF_TABLE_PAGE || type == LEAF_INDEX_PAGE;
+    char* header = &page[headerOffset];
+    size_t pointerArray = headerOffset + (leaf ? LEAF_HEADER : INTERIOR_HEADER);
+
+    uint32_t contentStart = writer.usableSize;
+    for (size_t i = 0; i < cells.size(); i++) {
+        contentStart -= cells[i].size();
+        memcpy(&page[contentStart], cells[i].data(), cells[i].size());
+        put2(&page[pointerArray + i * CELL_POINTER], contentStart);
+    }
+    if (pointerArray + cells.size() * CELL_POINTER > contentStart) {
+        throw std::runtime_error("Cells overflow the page.");
+    }
+
+    header[0] = static_cast<char>(type);
+    put2(header + 1, 0);                    // first freeblock
+    put2(header + 3, cells.size());         // cell count
+    put2(header + 5, contentStart == 65536 ? 0 : contentStart);
+    header[7] = 0;                          // fragmented free bytes
+    if (!leaf) put4(header + 8, rightPointer);
+    return page;
+}
+
+// a child of the level being built | `key` is the largest rowid below it on table b-trees
+struct ChildPage {
+    uint32_t pageNo;
+    int64_t key;
+};
+
+// build the interior levels above `children` | returns the root page number
+static uint32_t buildTableInterior(PageWriter& writer, std::vector<ChildPage> children) {
+    while (children.size() > 1) {
+        std::vector<ChildPage> parents;
+        size_t n = children.size();
+        size_t i = 0;
+        while (i < n) {
+            // children[i..k-1] become cells, children[k] the right pointer
+            size_t used = INTERIOR_HEADER;
+            size_t k = i;
+            while (k + 1 < n && used + 4 + varintLength(children[k].key) + CELL_POINTER <= writer.usableSize) {
+                used += 4 + varintLength(children[k].key) + CELL_POINTER;
+                k++;
+            }
+            // never leave a lone child for a page without cells
+            if (n - (k + 1) == 1 && k - 1 > i) k--;
+
+            std::vector<std::string> cells;
+            for (size_t j = i; j < k; j++) {
+                std::string cell(4, '\0');
+                put4(&cell[0], children[j].pageNo);
+                appendVarint(cell, children[j].key);
+                cells.push_back(cell);
+            }
+            uint32_t pageNo = writer.allocate();
+            writer.write(pageNo, buildPage(writer, INTERIOR_TABLE_PAGE, cells, children[k].pageNo));
+            parents.push_back({pageNo, children[k].key});
+            i = k + 1;
+        }
+        children.swap(parents);
+    }
+    return children[0].pageNo;
+}
+
+// build the interior levels above `children`, `separators[j]` sorting between children j and j + 1
+static uint32_t buildIndexInterior(PageWriter& writer, std::vector<uint32_t> children,
+                                   std::vector<std::string> separators) {
+    while (children.size() > 1) {
+        std::vector<uint32_t> parents;
+        std::vector<std::string> promoted;
+        size_t n = children.size();
+        size_t i = 0;
+        while (i < n) {
+            // cells pair children[j] with separators[j] for j in i..k-1, children[k] is the right pointer
+            size_t used = INTERIOR_HEADER;
+            size_t k = i;
+            while (k + 1 < n && used + 4 + separators[k].size() + CELL_POINTER <= writer.usableSize) {
+                used += 4 + separators[k].size() + CELL_POINTER;
+                k++;
+            }
+            if (n - (k + 1) == 1 && k - 1 > i) k--;
+
+            std::vector<std::string> cells;
+            for (size_t j = i; j < k; j++) {
+                std::string cell(4, '\0');
+                put4(&cell[0], children[j]);
+                cells.push_back(cell + separators[j]);
+            }
+            uint32_t pageNo = writer.allocate();
+            writer.write(pageNo, buildPage(writer, INTERIOR_INDEX_PAGE, cells, children[k]));
+            parents.push_back(pageNo);
+            // the separator after this page's right child moves up a level
+            if (k < n - 1) promoted.push_back(separators[k]);
+            i = k + 1;
+        }
+        children.swap(parents);
+        separators.swap(promoted);
+    }
+    return children[0];
+}
+
+static std::string randomText(uint64_t& state, size_t minLength, size_t maxLength) {
+    size_t length = minLength + (maxLength > minLength ? nextRandom(state) % (maxLength - minLength + 1) : 0);
+    // mostly lowercase ASCII with some 2, 3 and 4 byte UTF-8 characters mixed in
+    static const char* extra[] = {"\u00df", "\u0416", "\u4e2d", "\U0001f600"};
+    std::string text;
+    text.reserve(length);
+    for (size_t i = 0; i < length; i++) {
+        uint64_t r = nextRandom(state) % 30;
+        if (r < 26) text += static_cast<char>('a' + r);
+        else text += extra[r - 26];
+    }
+    return text;
+}
+
+static int64_t randomInteger(uint64_t& state) {
+    // cycle through magnitudes so every integer serial type shows up
+    static const int bits[] = {0, 1, 7, 15, 23, 31, 47, 63};
+    int width = bits[nextRandom(state) % 8];
+    if (width == 0) return nextRandom(state) % 2;
+    int64_t value = static_cast<int64_t>(nextRandom(state) >> (64 - width));
+    return nextRandom(state) % 2 ? -value : value;
+}
+
+// the values of row `rowid` | the rowid alias is stored as NULL
+static std::vector<RecordValue> generateRow(uint64_t rowid, const GeneratorOptions& options, uint64_t& state) {
+    std::vector<RecordValue> values = {nullValue()};
+    for (ColumnKind kind : options.columns) {
+        switch (kind) {
+            case ColumnKind::Key:
+                values.push_back(textValue(keyValue(rowid, options.cardinality), options.encoding));
+                break;
+            case ColumnKind::Int:
+                values.push_back(integerValue(randomInteger(state)));
+                break;
+            case ColumnKind::Real: {
+                double real = static_cast<double>(randomInteger(state) % 1000000) / 64.0;
+                // numeric looking text in a REAL column | readers must leave it as text
+                if (options.realTextEvery && rowid % options.realTextEvery == 0) {
+                    std::ostringstream ss;
+                    ss << real;
+                    values.push_back(textValue(ss.str(), options.encoding));
+                } else {
+                    values.push_back(realValue(real));
+                }
+                break;
+            }
+            case ColumnKind::Text:
+                values.push_back(textValue(randomText(state, options.textMin, options.textMax), options.encoding));
+                break;
+        }
+    }
+    return values;
+}
+
+// sort key of an index entry | text is kept encoded, BINARY collation is memcmp in the database encoding
+struct IndexEntry {
+    int storageClass;   // 1 numeric, 2 text
+    int64_t integer;
+    double real;
+    std::string text;
+    int64_t rowid;
+    std::string record;
+};
+
+// an index holds a single column, so entries are all integers, all reals or all text
+static bool entryLess(const IndexEntry& a, const IndexEntry& b) {
+    if (a.storageClass != b.storageClass) return a.storageClass < b.storageClass;
+    if (a.text != b.text) return a.text < b.text;
+    if (a.integer != b.integer) return a.integer < b.integer;
+    if (a.real != b.real) return a.real < b.real;
+    return a.rowid < b.rowid;
+}
+
+static IndexEntry makeIndexEntry(const RecordValue& value, ColumnKind kind, uint64_t rowid) {
+    IndexEntry entry = {1, 0, 0.0, "", static_cast<int64_t>(rowid), encodeRecord({value, integerValue(rowid)})};
+    // record bodies are big-endian
+    uint64_t bits = (!value.body.empty() && (value.body[0] & 0x80)) ? ~uint64_t(0) : 0;
+    for (char c : value.body) bits = (bits << 8) | static_cast<unsigned char>(c);
+    switch (kind) {
+        case ColumnKind::Key:
+        case ColumnKind::Text:
+            entry.storageClass = 2;
+            entry.text = value.body;
+            break;
+        case ColumnKind::Real:
+            memcpy(&entry.real, &bits, sizeof(bits));
+            break;
+        case ColumnKind::Int:
+            entry.integer = value.serialType == 9 ? 1 : static_cast<int64_t>(bits);
+            break;
+    }
+    return entry;
+}
+
+static uint32_t writeIndex(PageWriter& writer, std::vector<IndexEntry>& entries) {
+    std::sort(entries.begin(), entries.end(), entryLess);
+
+    // cell content without the left child pointer | same local size on leaf and interior pages
+    std::vector<std::string> cells(entries.size());
+    for (size_t i = 0; i < entries.size(); i++) {
+        appendVarint(cells[i], entries[i].record.size());
+        cells[i] += writer.spill(entries[i].record, false);
+        std::string().swap(entries[i].record);
+    }
+
+    std::vector<uint32_t> children;
+    std::vector<std::string> separators;
+    std::vector<std::string> leaf;
+    size_t used = LEAF_HEADER;
+    for (size_t i = 0; i < cells.size(); i++) {
+        if (used + cells[i].size() + CELL_POINTER > writer.usableSize && !leaf.empty()) {
+            uint32_t pageNo = writer.allocate();
+            writer.write(pageNo, buildPage(writer, LEAF_INDEX_PAGE, leaf, 0));
+            children.push_back(pageNo);
+            leaf.clear();
+            used = LEAF_HEADER;
+            // the entry that didn't fit separates this leaf from the next one
+            if (i + 1 < cells.size()) {
+                separators.push_back(cells[i]);
+                continue;
+            }
+        }
+        leaf.push_back(cells[i]);
+        used += cells[i].size() + CELL_POINTER;
+    }
+    uint32_t pageNo = writer.allocate();
+    writer.write(pageNo, buildPage(writer, LEAF_INDEX_PAGE, leaf, 0));
+    children.push_back(pageNo);
+    return buildIndexInterior(writer, children, separators);
+}
+
+static void writeHeader(std::string& page, const GeneratorOptions& options, uint32_t pageCount) {
+    memcpy(&page[0], "SQLite format 3", 16);
+    put2(&page[16], options.pageSize == 65536 ? 1 : options.pageSize);
+    page[18] = 1;                                // file format write version | legacy
+    page[19] = 1;                                // file format read version | legacy
+    page[20] = static_cast<char>(options.reservedBytes);
+    page[21] = 64;                               // maximum embedded payload fraction
+    page[22] = 32;                               // minimum embedded payload fraction
+    page[23] = 32;                               // leaf payload fraction
+    put4(&page[24], 1);                          // file change counter
+    put4(&page[28], pageCount);                  // database size in pages
+    put4(&page[40], options.schemaCookie);       // schema cookie
+    put4(&page[44], 4);                          // schema format number
+    put4(&page[56], options.encoding);           // text encoding
+    put4(&page[92], 1);                          // version-valid-for number
+    put4(&page[96], 3040001);                    // SQLITE_VERSION_NUMBER
+}
+
+void writeDatabase(const std::string& path, const GeneratorOptions& options) {
+    if (options.pageSize < 512 || options.pageSize > 65536 || (options.pageSize & (options.pageSize - 1))) {
+        throw std::invalid_argument("Page size must be a power of two between 512 and 65536.");
+    }
+    if (options.pageSize - options.reservedBytes < 480 || options.reservedBytes > 255) {
+        throw std::invalid_argument("Reserved bytes must leave a usable size of at least 480.");
+    }
+    if (options.textMin > options.textMax || options.cardinality == 0) {
+        throw std::invalid_argument("Invalid text size range or cardinality.");
+    }
+
+    std::vector<std::string> names = columnNames(options);
+    std::vector<int> indexed;
+    for (const std::string& index : options.indexes) {
+        auto it = std::find(names.begin(), names.end(), index);
+        if (it == names.end() || it == names.begin()) throw std::invalid_argument("Can't index column: " + index);
+        indexed.push_back(it - names.begin());
+    }
+
+    PageWriter writer(path, options);
+    uint64_t state = options.seed;
+
+    // table b-tree | rows arrive in rowid order, leaves are filled left to right
+    std::vector<std::vector<IndexEntry>> indexEntries(indexed.size());
+    std::vector<ChildPage> leaves;
+    std::vector<std::string> leaf;
+    size_t used = LEAF_HEADER;
+    int64_t lastRowid = 0;
+    for (uint64_t rowid = 1; rowid <= options.rows; rowid++) {
+        std::vector<RecordValue> values = generateRow(rowid, options, state);
+        std::string record = encodeRecord(values);
+
+        for (size_t i = 0; i < indexed.size(); i++) {
+            indexEntries[i].push_back(makeIndexEntry(values[indexed[i]], options.columns[indexed[i] - 1], rowid));
+        }
+
+        std::string cell;
+        appendVarint(cell, record.size());
+        appendVarint(cell, rowid);
+        cell += writer.spill(record, true);
+        if (used + cell.size() + CELL_POINTER > writer.usableSize) {
+            uint32_t pageNo = writer.allocate();
+            writer.write(pageNo, buildPage(writer, LEAF_TABLE_PAGE, leaf, 0));
+            leaves.push_back({pageNo, lastRowid});
+            leaf.clear();
+            used = LEAF_HEADER;
+        }
+        leaf.push_back(cell);
+        used += cell.size() + CELL_POINTER;
+        lastRowid = rowid;
+    }
+    uint32_t leafPage = writer.allocate();
+    writer.write(leafPage, buildPage(writer, LEAF_TABLE_PAGE, leaf, 0));
+    leaves.push_back({leafPage, lastRowid});
+    uint32_t tableRoot = buildTableInterior(writer, leaves);
+
+    // sqlite_schema rows
+    std::vector<std::vector<RecordValue>> schema;
+    std::string sql = "CREATE TABLE " + options.table + " (id integer primary key";
+    const char* types[4] = {"text", "integer", "real", "text"};
+    for (size_t i = 0; i < options.columns.size(); i++) {
+        sql += ", " + names[i + 1] + " " + types[static_cast<int>(options.columns[i])];
+    }
+    sql += ")";
+    schema.push_back({textValue("table", options.encoding), textValue(options.table, options.encoding),
+                      textValue(options.table, options.encoding), integerValue(tableRoot),
+                      textValue(sql, options.encoding)});
+    for (size_t i = 0; i < indexed.size(); i++) {
+        uint32_t indexRoot = writeIndex(writer, indexEntries[i]);
+        std::string name = "idx_" + options.table + "_" + names[indexed[i]];
+        schema.push_back({textValue("index", options.encoding), textValue(name, options.encoding),
+                          textValue(options.table, options.encoding), integerValue(indexRoot),
+                          textValue("CREATE INDEX " + name + " ON " + options.table + " (" + names[indexed[i]] + ")",
+                                    options.encoding)});
+    }
+
+    // page 1 | database header followed by the sqlite_schema leaf
+    std::vector<std::string> cells;
+    used = DATABASE_HEADER + LEAF_HEADER;
+    for (size_t i = 0; i < schema.size(); i++) {
+        std::string record = encodeRecord(schema[i]);
+        std::string cell;
+        appendVarint(cell, record.size());
+        appendVarint(cell, i + 1);
+        cell += writer.spill(record, true);
+        used += cell.size() + CELL_POINTER;
+        cells.push_back(cell);
+    }
+    if (used > writer.usableSize) throw std::runtime_error("sqlite_schema doesn't fit on page 1.");
+    std::string page = buildPage(writer, LEAF_TABLE_PAGE, cells, 0, DATABASE_HEADER);
+    writeHeader(page, options, writer.pageCount());
+    writer.write(1, page);
+}
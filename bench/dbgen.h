@@ -0,0 +1,45 @@
+#ifndef DBGEN_H
+#define DBGEN_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "utility.h"
+
+// kinds of generated columns | every table also has an `id integer primary key`
+enum class ColumnKind {
+    Key,    // low cardinality text "<prefix><n>" with mostly non-ASCII prefixes, meant for filters and indexes
+    Int,    // integers spread over every integer serial type
+    Real,   // 8-byte floats
+    Text    // random text of `textMin`..`textMax` characters, mostly lowercase ASCII
+};
+
+struct GeneratorOptions {
+    uint32_t pageSize;
+    unsigned short reservedBytes;
+    uint64_t rows;
+    std::vector<ColumnKind> columns;
+    size_t textMin;
+    size_t textMax;
+    unsigned cardinality;              // distinct values of Key columns
+    std::vector<std::string> indexes;  // columns to index, one single column index each
+    SQLiteEncoding encoding;
+    uint64_t seed;
+    std::string table;
+    uint32_t schemaCookie;             // written to the header | bump it when rewriting a file with a new schema
+    unsigned realTextEvery;            // store Real values of every n-th row as text | 0 never, PRAGMA integrity_check flags it
+
+    GeneratorOptions();
+};
+
+// parse a comma separated column mix like "key,int,text,real"
+std::vector<ColumnKind> parseColumnKinds(const std::string& spec);
+// names of the generated columns in record order | "id" first
+std::vector<std::string> columnNames(const GeneratorOptions& options);
+// value of Key column in row `rowid`
+std::string keyValue(uint64_t rowid, unsigned cardinality);
+
+// write a database following `options` to `path` | throws on invalid options or IO failure
+void writeDatabase(const std::string& path, const GeneratorOptions& options);
+
+#endif // DBGEN_H
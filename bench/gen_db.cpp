@@ -0,0 +1,60 @@
+#include <cstring>
+#include <iostream>
+#include <string>
+#include "dbgen.h"
+
+static void usage() {
+    std::cerr << "usage: gen_db <output.db> [options]\n"
+                 "  --page-size N       power of two in 512..65536 (4096)\n"
+                 "  --reserved N        reserved bytes at the end of each page (0)\n"
+                 "  --rows N            number of rows (10000)\n"
+                 "  --columns SPEC      column mix of key,int,real,text (key,int,text,real)\n"
+                 "  --text-min N        shortest text value (8)\n"
+                 "  --text-max N        longest text value | above the page size spills to overflow pages (32)\n"
+                 "  --cardinality N     distinct values of key columns (100)\n"
+                 "  --index COLUMN      add an index on COLUMN, e.g. key1 | repeatable\n"
+                 "  --encoding E        utf8, utf16le or utf16be (utf8)\n"
+                 "  --real-text-every N store real values of every N-th row as text (0, never)\n"
+                 "  --seed N            random seed (1)\n"
+                 "  --table NAME        table name (bench)" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 || argv[1][0] == '-') {
+        usage();
+        return 1;
+    }
+
+    GeneratorOptions options;
+    try {
+        for (int i = 2; i < argc; i++) {
+            std::string option = argv[i];
+            if (i + 1 >= argc) throw std::invalid_argument("Missing value for " + option);
+            std::string value = argv[++i];
+            if (option == "--page-size") options.pageSize = std::stoul(value);
+            else if (option == "--reserved") options.reservedBytes = std::stoul(value);
+            else if (option == "--rows") options.rows = std::stoull(value);
+            else if (option == "--columns") options.columns = parseColumnKinds(value);
+            else if (option == "--text-min") options.textMin = std::stoul(value);
+            else if (option == "--text-max") options.textMax = std::stoul(value);
+            else if (option == "--cardinality") options.cardinality = std::stoul(value);
+            else if (option == "--index") options.indexes.push_back(value);
+            else if (option == "--real-text-every") options.realTextEvery = std::stoul(value);
+            else if (option == "--seed") options.seed = std::stoull(value);
+            else if (option == "--table") options.table = value;
+            else if (option == "--encoding") {
+                if (value == "utf8") options.encoding = SQLiteEncoding::SQLITE_UTF8;
+                else if (value == "utf16le") options.encoding = SQLiteEncoding::SQLITE_UTF16LE;
+                else if (value == "utf16be") options.encoding = SQLiteEncoding::SQLITE_UTF16BE;
+                else throw std::invalid_argument("Unknown encoding: " + value);
+            }
+            else throw std::invalid_argument("Unknown option: " + option);
+        }
+        writeDatabase(argv[1], options);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        usage();
+        return 1;
+    }
+    return 0;
+}
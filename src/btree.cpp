@@ -0,0 +1,280 @@
+#include "btree.h"
+#include <algorithm>
+#include "config.h"
+
+static uint64_t pagesRead = 0;
+
+uint64_t getPagesRead() {
+    return pagesRead;
+}
+
+bool readPage(std::istream& db_file, uint32_t pageNo, BtreePage& page) {
+    uint32_t pageSize = Config::getInstance()->getPageSize();
+    page.pageNo = pageNo;
+    page.data.resize(pageSize);
+    db_file.clear();
+    db_file.seekg(static_cast<std::streamoff>(pageNo - 1) * pageSize);
+    db_file.read(&page.data[0], pageSize);
+    if (db_file.gcount() != pageSize) return false;
+    pagesRead++;
+
+    // page 1 starts with the database header
+    page.headerOffset = pageNo == 1 ? DATABASE_HEADER : 0;
+    const char* header = page.data.data() + page.headerOffset;
+    page.type = static_cast<uint8_t>(header[0]);
+    page.cellCount = read2ByteInt(header + 3);
+    page.rightPointer = isLeafPage(page) ? 0 : read4ByteInt(header + 8);
+    return true;
+}
+
+bool isLeafPage(const BtreePage& page) {
+    return page.type == LEAF_TABLE_PAGE || page.type == LEAF_INDEX_PAGE;
+}
+
+bool isIndexPage(const BtreePage& page) {
+    return page.type == LEAF_INDEX_PAGE || page.type == INTERIOR_INDEX_PAGE;
+}
+
+// cell content offset of cell `cell`, relative to the start of the page
+static unsigned short getCellOffset(const BtreePage& page, int cell) {
+    // leaf page header is 8 bytes, interior page header 12 bytes
+    unsigned short pointerArray = page.headerOffset + (isLeafPage(page) ? 8 : 12);
+    return read2ByteInt(page.data.data() + pointerArray + cell * CELL_POINTER);
+}
+
+// read a payload of `nbytesPayload` bytes starting at `offset` of `page`, spilling onto overflow pages
+static void readPayload(std::istream& db_file, const BtreePage& page, unsigned short offset,
+                        varint nbytesPayload, std::string& payload) {
+    /**
+     * U = usable page size
+     * X is the most payload that can be kept on a b-tree page, M the least that is kept
+     * there once it spills. Anything past the local part lives on a linked list of
+     * overflow pages, each one holding a 4-byte next page number and U - 4 bytes of payload
+     */
+    uint32_t U = Config::getInstance()->getUsableSize();
+    varint X = page.type == LEAF_TABLE_PAGE ? U - 35 : ((U - 12) * 64 / 255) - 23;
+    varint localSize = nbytesPayload;
+    if (nbytesPayload > X) {
+        varint M = ((U - 12) * 32 / 255) - 23;
+        varint K = M + ((nbytesPayload - M) % (U - 4));
+        localSize = K <= X ? K : M;
+    }
+    payload.assign(page.data.data() + offset, localSize);
+    if (localSize == nbytesPayload) return;
+
+    uint32_t overflowPage = read4ByteInt(page.data.data() + offset + localSize);
+    char buffer[4];
+    while (overflowPage != 0 && static_cast<varint>(payload.size()) < nbytesPayload) {
+        db_file.clear();
+        db_file.seekg(static_cast<std::streamoff>(overflowPage - 1) * Config::getInstance()->getPageSize());
+        db_file.read(buffer, 4);
+        pagesRead++;
+        size_t chunk = std::min<varint>(U - 4, nbytesPayload - payload.size());
+        size_t start = payload.size();
+        payload.resize(start + chunk);
+        db_file.read(&payload[start], chunk);
+        if (static_cast<size_t>(db_file.gcount()) != chunk) {
+            throw std::runtime_error("Failed to read overflow page.");
+        }
+        overflowPage = read4ByteInt(buffer);
+    }
+}
+
+void readCell(std::istream& db_file, const BtreePage& page, int cell, BtreeCell& out) {
+    unsigned short offset = getCellOffset(page, cell);
+    const char* content = page.data.data() + offset;
+    int nBytes = 0;
+    out.leftChild = 0;
+    out.rowid = 0;
+    switch (page.type) {
+        case LEAF_TABLE_PAGE: {
+            // varint payload size | varint rowid | payload | overflow page
+            varint nbytesPayload = readVarint(content, &nBytes);
+            offset += nBytes;
+            out.rowid = readVarint(page.data.data() + offset, &nBytes);
+            offset += nBytes;
+            readPayload(db_file, page, offset, nbytesPayload, out.payload);
+            break;
+        }
+        case INTERIOR_TABLE_PAGE: {
+            // 4-byte left child | varint rowid
+            out.leftChild = read4ByteInt(content);
+            out.rowid = readVarint(content + 4, &nBytes);
+            out.payload.clear();
+            break;
+        }
+        case LEAF_INDEX_PAGE: {
+            // varint payload size | payload | overflow page
+            varint nbytesPayload = readVarint(content, &nBytes);
+            readPayload(db_file, page, offset + nBytes, nbytesPayload, out.payload);
+            break;
+        }
+        case INTERIOR_INDEX_PAGE: {
+            // 4-byte left child | varint payload size | payload | overflow page
+            out.leftChild = read4ByteInt(content);
+            varint nbytesPayload = readVarint(content + 4, &nBytes);
+            readPayload(db_file, page, offset + 4 + nBytes, nbytesPayload, out.payload);
+            break;
+        }
+        default:
+            throw std::runtime_error("Not a b-tree page.");
+    }
+}
+
+void scanTableBtree(std::istream& db_file, uint32_t rootPage, const TableRowCallback& callback) {
+    BtreeCursor cursor(db_file, rootPage);
+    BtreeCell cell;
+    while (cursor.next(cell)) {
+        if (!callback(cell.rowid, cell.payload)) break;
+    }
+}
+
+bool seekTableRowid(std::istream& db_file, uint32_t rootPage, varint rowid, std::string& payload) {
+    BtreePage page;
+    BtreeCell cell;
+    uint32_t pageNo = rootPage;
+    while (true) {
+        if (!readPage(db_file, pageNo, page)) throw std::runtime_error("Failed to read table page.");
+        if (page.type == LEAF_TABLE_PAGE) break;
+        if (page.type != INTERIOR_TABLE_PAGE) throw std::runtime_error("Not a table b-tree page.");
+
+        // left child of the first cell with key >= rowid | right pointer when there is none
+        int lo = 0, hi = page.cellCount;
+        while (lo < hi) {
+            int mid = (lo + hi) / 2;
+            int nBytes;
+            varint key = readVarint(page.data.data() + getCellOffset(page, mid) + 4, &nBytes);
+            if (key < rowid) lo = mid + 1;
+            else hi = mid;
+        }
+        pageNo = lo == page.cellCount ? page.rightPointer
+                                      : read4ByteInt(page.data.data() + getCellOffset(page, lo));
+    }
+
+    int lo = 0, hi = page.cellCount - 1;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        int nBytes;
+        const char* content = page.data.data() + getCellOffset(page, mid);
+        readVarint(content, &nBytes);  // payload size
+        varint key = readVarint(content + nBytes, &nBytes);
+        if (key == rowid) {
+            readCell(db_file, page, mid, cell);
+            payload.swap(cell.payload);
+            return true;
+        }
+        if (key < rowid) lo = mid + 1;
+        else hi = mid - 1;
+    }
+    return false;
+}
+
+// compare the first column of an index entry against `key`
+static int compareFirstColumn(const std::string& payload, const Data& key) {
+    Data column;
+    if (decodeRecord(payload, &column, 1) == 0) return -1;
+    int cmp = compareData(column, key);
+    freeDataColumns(&column, 1);
+    return cmp;
+}
+
+// child `child` of an interior page | the right pointer follows the last cell
+static uint32_t childPage(const BtreePage& page, int child) {
+    return child < page.cellCount ? read4ByteInt(page.data.data() + getCellOffset(page, child)) : page.rightPointer;
+}
+
+BtreeCursor::BtreeCursor(std::istream& db_file, uint32_t rootPage, const Data* key)
+    : db_file(db_file), rootPage(rootPage), key(key), started(false) {}
+
+void BtreeCursor::descend(uint32_t pageNo, bool seek) {
+    BtreeCell cell;
+    while (true) {
+        Frame frame;
+        if (!readPage(db_file, pageNo, frame.page)) throw std::runtime_error("Failed to read b-tree page.");
+        const BtreePage& page = frame.page;
+        if (page.type != INTERIOR_INDEX_PAGE && page.type != INTERIOR_TABLE_PAGE && !isLeafPage(page)) {
+            throw std::runtime_error("Not a b-tree page.");
+        }
+        // first cell whose entry is >= key | everything before it sorts before `key`
+        int lo = 0, hi = page.cellCount;
+        while (seek && key && isIndexPage(page) && lo < hi) {
+            int mid = (lo + hi) / 2;
+            readCell(db_file, page, mid, cell);
+            if (compareFirstColumn(cell.payload, *key) < 0) lo = mid + 1;
+            else hi = mid;
+        }
+        frame.cell = seek && key ? lo : 0;
+        frame.descend = false;
+        bool leaf = isLeafPage(page);
+        uint32_t child = leaf ? 0 : childPage(page, frame.cell);
+        stack.push_back(std::move(frame));
+        if (leaf) return;
+        pageNo = child;
+    }
+}
+
+bool BtreeCursor::next(BtreeCell& cell) {
+    if (!started) {
+        started = true;
+        descend(rootPage, true);
+    }
+    while (!stack.empty()) {
+        Frame& frame = stack.back();
+        if (frame.descend) {
+            frame.descend = false;
+            descend(childPage(frame.page, frame.cell), false);
+            continue;
+        }
+        if (isLeafPage(frame.page)) {
+            if (frame.cell == frame.page.cellCount) {
+                stack.pop_back();
+                continue;
+            }
+            readCell(db_file, frame.page, frame.cell++, cell);
+        } else {
+            // back from child `cell` | its separator comes next, then the child after it
+            if (frame.cell == frame.page.cellCount) {
+                stack.pop_back();
+                continue;
+            }
+            int separator = frame.cell++;
+            frame.descend = true;
+            // table interior cells only hold keys
+            if (frame.page.type == INTERIOR_TABLE_PAGE) continue;
+            readCell(db_file, frame.page, separator, cell);
+        }
+        // entries past `key` end the seek
+        if (key && compareFirstColumn(cell.payload, *key) > 0) {
+            stack.clear();
+            return false;
+        }
+        return true;
+    }
+    return false;
+}
+
+uint64_t countBtreeEntries(std::istream& db_file, uint32_t rootPage) {
+    BtreePage page;
+    if (!readPage(db_file, rootPage, page)) throw std::runtime_error("Failed to read b-tree page.");
+    if (page.type == LEAF_TABLE_PAGE || page.type == LEAF_INDEX_PAGE) return page.cellCount;
+
+    // index interior cells carry an entry of their own, table interior cells only a key
+    uint64_t count = page.type == INTERIOR_INDEX_PAGE ? page.cellCount : 0;
+    for (int i = 0; i < page.cellCount; i++) {
+        count += countBtreeEntries(db_file, read4ByteInt(page.data.data() + getCellOffset(page, i)));
+    }
+    return count + countBtreeEntries(db_file, page.rightPointer);
+}
+
+uint64_t estimateBtreePages(std::istream& db_file, uint32_t rootPage) {
+    BtreePage page;
+    uint64_t pages = 1, levelWidth = 1;
+    uint32_t pageNo = rootPage;
+    while (readPage(db_file, pageNo, page) && !isLeafPage(page)) {
+        // assume every page of a level has the fan-out of its leftmost page
+        levelWidth *= page.cellCount + 1;
+        pages += levelWidth;
+        pageNo = page.cellCount ? read4ByteInt(page.data.data() + getCellOffset(page, 0)) : page.rightPointer;
+    }
+    return pages;
+}
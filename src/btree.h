@@ -0,0 +1,85 @@
+#ifndef BTREE_H
+#define BTREE_H
+
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <string>
+#include <vector>
+#include "utility.h"
+
+#define DATABASE_HEADER 100
+#define CELL_POINTER 2
+
+// b-tree page types | first byte of the b-tree page header
+#define INTERIOR_INDEX_PAGE 0x02
+#define INTERIOR_TABLE_PAGE 0x05
+#define LEAF_INDEX_PAGE 0x0a
+#define LEAF_TABLE_PAGE 0x0d
+
+struct BtreePage {
+    uint32_t pageNo;
+    std::string data;              // raw page bytes
+    unsigned short headerOffset;   // 100 on page 1 | 0 elsewhere
+    uint8_t type;
+    unsigned short cellCount;
+    uint32_t rightPointer;         // interior pages only
+};
+
+struct BtreeCell {
+    uint32_t leftChild;    // interior pages only
+    varint rowid;          // table pages only
+    std::string payload;   // complete payload, overflow pages included | not for interior table pages
+};
+
+// Callback returns false to stop the traversal.
+typedef std::function<bool(varint rowid, const std::string& payload)> TableRowCallback;
+
+// read page `pageNo` (1 based) from `db_file` and parse its b-tree page header
+bool readPage(std::istream& db_file, uint32_t pageNo, BtreePage& page);
+bool isLeafPage(const BtreePage& page);
+bool isIndexPage(const BtreePage& page);
+
+// read cell `cell` of `page` into `out`, following overflow pages for the payload
+void readCell(std::istream& db_file, const BtreePage& page, int cell, BtreeCell& out);
+
+// visit every row of the table b-tree rooted at `rootPage` in rowid order
+void scanTableBtree(std::istream& db_file, uint32_t rootPage, const TableRowCallback& callback);
+// find the row with `rowid` in the table b-tree rooted at `rootPage`
+bool seekTableRowid(std::istream& db_file, uint32_t rootPage, varint rowid, std::string& payload);
+
+// Walks a b-tree one cell at a time, reading pages only as cells are asked for:
+// table rows in rowid order, index entries in key order.
+// With a `key`, only index entries whose first column equals `key` are returned and
+// subtrees that can't hold such entries are never read. `key` must outlive the cursor.
+class BtreeCursor {
+public:
+    BtreeCursor(std::istream& db_file, uint32_t rootPage, const Data* key = nullptr);
+    // read the next cell into `cell` | false once there are no more
+    bool next(BtreeCell& cell);
+
+private:
+    struct Frame {
+        BtreePage page;
+        int cell;      // next cell of a leaf | child being walked of an interior page
+        bool descend;  // interior pages only: child `cell` is still to be entered
+    };
+    // push the path from `pageNo` down to a leaf | leftmost, or the first entry >= `key` when seeking
+    void descend(uint32_t pageNo, bool seek);
+
+    std::istream& db_file;
+    uint32_t rootPage;
+    const Data* key;
+    std::vector<Frame> stack;
+    bool started;
+};
+
+// number of rows / entries stored in the b-tree rooted at `rootPage`, read from page headers only
+uint64_t countBtreeEntries(std::istream& db_file, uint32_t rootPage);
+// estimate the page count of the b-tree rooted at `rootPage` from its leftmost path
+uint64_t estimateBtreePages(std::istream& db_file, uint32_t rootPage);
+
+// number of b-tree and overflow pages read from the database file so far
+uint64_t getPagesRead();
+
+#endif // BTREE_H
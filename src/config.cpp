@@ -3,7 +3,7 @@
 
 Config* Config::instance = nullptr;
 
-Config::Config() : textEncoding(SQLiteEncoding::SQLITE_UTF8) {}  // Initialize to UTF-8 by default.
+Config::Config() : textEncoding(SQLiteEncoding::SQLITE_UTF8), pageSize(4096), reservedSize(0) {}  // Initialize to UTF-8 by default.
 
 Config* Config::getInstance() {
     if (instance == nullptr) {
@@ -19,3 +19,23 @@ SQLiteEncoding Config::getTextEncoding() const {
 void Config::setTextEncoding(SQLiteEncoding encoding) {
     textEncoding = encoding;
 }
+
+uint32_t Config::getPageSize() const {
+    return pageSize;
+}
+
+void Config::setPageSize(uint32_t size) {
+    pageSize = size;
+}
+
+unsigned short Config::getReservedSize() const {
+    return reservedSize;
+}
+
+void Config::setReservedSize(unsigned short size) {
+    reservedSize = size;
+}
+
+uint32_t Config::getUsableSize() const {
+    return pageSize - reservedSize;
+}
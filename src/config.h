@@ -7,6 +7,8 @@ class Config {
 private:
     static Config* instance;
     SQLiteEncoding textEncoding;
+    uint32_t pageSize;
+    unsigned short reservedSize;
 
     Config();  // Private constructor.
     Config(const Config&) = delete;  // Prevent copying.
@@ -16,6 +18,12 @@ public:
     static Config* getInstance();
     SQLiteEncoding getTextEncoding() const;
     void setTextEncoding(SQLiteEncoding encoding);
+    uint32_t getPageSize() const;
+    void setPageSize(uint32_t size);
+    unsigned short getReservedSize() const;
+    void setReservedSize(unsigned short size);
+    // usable size of a page | `U` in the file format documentation
+    uint32_t getUsableSize() const;
 };
 
 #endif // CONFIG_H
@@ -0,0 +1,340 @@
+#include "planner.h"
+#include <algorithm>
+#include <cstring>
+#include "btree.h"
+
+void parseLiteral(const std::string& token, Data& value) {
+    if (token.size() >= 2 && token.front() == '\'' && token.back() == '\'') {
+        value.type = DataType::TypeText;
+        value.value.text = strdup(token.substr(1, token.size() - 2).c_str());
+        return;
+    }
+    if (equalsIgnoreCase(token, "NULL")) {
+        value.type = DataType::TypeNull;
+        return;
+    }
+    char* end = nullptr;
+    if (token.find_first_of(".eE") == std::string::npos) {
+        long long integer = strtoll(token.c_str(), &end, 10);
+        value.type = DataType::TypeInt64;
+        value.value = DataUnion(static_cast<int64_t>(integer));
+    } else {
+        double real = strtod(token.c_str(), &end);
+        value.type = DataType::TypeFloat64;
+        value.value = DataUnion(real);
+    }
+    if (token.empty() || *end != '\0') throw std::invalid_argument("Unsupported literal: " + token);
+}
+
+bool parseSelect(const std::string& sql, SelectStatement& statement) {
+    DynamicArray tokens;
+    tokenizeSql(sql, tokens);
+    const std::string* data = tokens.getData();
+    size_t nTokens = tokens.getSize();
+    if (nTokens > 0 && data[nTokens - 1] == ";") nTokens--;
+
+    statement.countStar = false;
+    statement.columns.clear();
+    statement.hasWhere = false;
+    statement.whereValue.type = DataType::TypeNull;
+    if (nTokens == 0 || !equalsIgnoreCase(data[0], "SELECT")) {
+        throw std::invalid_argument("Only SELECT statements are supported.");
+    }
+
+    // result columns
+    size_t pos = 1;
+    if (pos + 3 < nTokens && equalsIgnoreCase(data[pos], "COUNT") && data[pos + 1] == "(" &&
+        data[pos + 2] == "*" && data[pos + 3] == ")") {
+        statement.countStar = true;
+        pos += 4;
+    } else {
+        while (pos < nTokens && !equalsIgnoreCase(data[pos], "FROM")) {
+            if (data[pos] != ",") statement.columns.push_back(data[pos]);
+            pos++;
+        }
+    }
+
+    if (pos + 1 >= nTokens || !equalsIgnoreCase(data[pos], "FROM")) {
+        throw std::invalid_argument("Expected FROM <table>.");
+    }
+    statement.table = data[pos + 1];
+    pos += 2;
+
+    if (pos < nTokens) {
+        if (pos + 4 != nTokens || !equalsIgnoreCase(data[pos], "WHERE") || data[pos + 2] != "=") {
+            throw std::invalid_argument("Only WHERE <column> = <literal> is supported.");
+        }
+        statement.hasWhere = true;
+        statement.whereColumn = data[pos + 1];
+        // a `?` parameter is bound when the statement runs
+        if (data[pos + 3] != "?") parseLiteral(data[pos + 3], statement.whereValue);
+    }
+    return true;
+}
+
+// record position of column `name` in table records | ROWID_COLUMN for the rowid and its alias
+static int resolveTableColumn(const TableSchema& table, const std::string& name) {
+    for (size_t i = 0; i < table.columns.size(); i++) {
+        if (equalsIgnoreCase(table.columns[i], name)) {
+            return static_cast<int>(i) == table.rowidAlias ? ROWID_COLUMN : static_cast<int>(i);
+        }
+    }
+    if (equalsIgnoreCase(name, "rowid") || equalsIgnoreCase(name, "oid") || equalsIgnoreCase(name, "_rowid_")) {
+        return ROWID_COLUMN;
+    }
+    throw std::invalid_argument("no such column: " + name);
+}
+
+// affinity of table column `column` | the rowid is always an integer
+static Affinity columnAffinity(const TableSchema& table, int column) {
+    return column == ROWID_COLUMN ? Affinity::Integer : table.affinities[column];
+}
+
+// position of table column `column` in the entries of `index` | NO_COLUMN when the index doesn't hold it
+static int resolveIndexColumn(const TableSchema& table, const IndexSchema& index, int column) {
+    // every index entry ends with the rowid
+    if (column == ROWID_COLUMN) return ROWID_COLUMN;
+    for (size_t i = 0; i < index.columns.size(); i++) {
+        if (equalsIgnoreCase(index.columns[i], table.columns[column])) return static_cast<int>(i);
+    }
+    return NO_COLUMN;
+}
+
+// an index covers the query when every referenced column can be read from its entries
+static bool coversColumns(const TableSchema& table, const IndexSchema& index, const std::vector<int>& columns) {
+    for (int column : columns) {
+        if (resolveIndexColumn(table, index, column) == NO_COLUMN) return false;
+    }
+    return true;
+}
+
+static void useIndex(QueryPlan& plan, AccessPath path, const TableSchema& table, const IndexSchema& index,
+                     const std::vector<int>& outputColumns, int whereColumn) {
+    plan.path = path;
+    plan.rootPage = index.rootPage;
+    plan.whereColumn = whereColumn == NO_COLUMN ? NO_COLUMN : resolveIndexColumn(table, index, whereColumn);
+    plan.outputColumns.clear();
+    for (int column : outputColumns) plan.outputColumns.push_back(resolveIndexColumn(table, index, column));
+}
+
+QueryPlan planSelect(const SelectStatement& statement, const TableSchema& table, std::istream& db_file) {
+    QueryPlan plan;
+    plan.countStar = statement.countStar;
+    plan.tableRootPage = table.rootPage;
+    plan.rootPage = table.rootPage;
+    plan.filter = false;
+
+    // resolve every referenced column against the table
+    std::vector<int> outputColumns;
+    for (const std::string& column : statement.columns) {
+        if (column == "*") {
+            for (size_t i = 0; i < table.columns.size(); i++) {
+                outputColumns.push_back(static_cast<int>(i) == table.rowidAlias ? ROWID_COLUMN : static_cast<int>(i));
+            }
+        } else {
+            outputColumns.push_back(resolveTableColumn(table, column));
+        }
+    }
+    int whereColumn = statement.hasWhere ? resolveTableColumn(table, statement.whereColumn) : NO_COLUMN;
+    std::vector<int> referenced = outputColumns;
+    if (statement.hasWhere) referenced.push_back(whereColumn);
+
+    // table record columns to decode | up to the last referenced one
+    plan.recordColumns = 0;
+    for (int column : referenced) plan.recordColumns = std::max(plan.recordColumns, column + 1);
+    plan.outputColumns = outputColumns;
+    plan.whereColumn = whereColumn;
+    plan.whereAffinity = statement.hasWhere ? columnAffinity(table, whereColumn) : Affinity::Blob;
+    plan.outputAffinities.clear();
+    for (int column : outputColumns) plan.outputAffinities.push_back(columnAffinity(table, column));
+
+    if (statement.hasWhere && whereColumn == ROWID_COLUMN) {
+        plan.path = AccessPath::RowidSeek;
+        return plan;
+    }
+
+    if (statement.hasWhere) {
+        // an index led by the filtered column reads only the matching entries
+        const IndexSchema* seekIndex = nullptr;
+        for (const IndexSchema& index : table.indexes) {
+            if (!index.seekable || resolveIndexColumn(table, index, whereColumn) != 0) continue;
+            if (coversColumns(table, index, referenced)) {
+                useIndex(plan, AccessPath::CoveringIndexSeek, table, index, outputColumns, whereColumn);
+                return plan;
+            }
+            if (!seekIndex) seekIndex = &index;
+        }
+        if (seekIndex) {
+            plan.path = AccessPath::IndexSeek;
+            plan.rootPage = seekIndex->rootPage;
+            return plan;
+        }
+    }
+
+    // otherwise read whichever b-tree holding the referenced columns has the fewest pages
+    // the table always qualifies, COUNT(*) without a filter is answered by any index
+    uint64_t fewestPages = estimateBtreePages(db_file, table.rootPage);
+    const IndexSchema* smallest = nullptr;
+    for (const IndexSchema& index : table.indexes) {
+        if (!coversColumns(table, index, referenced)) continue;
+        uint64_t pages = estimateBtreePages(db_file, index.rootPage);
+        if (pages < fewestPages) {
+            fewestPages = pages;
+            smallest = &index;
+        }
+    }
+
+    if (statement.countStar && !statement.hasWhere) {
+        plan.path = AccessPath::CountBtree;
+        plan.rootPage = smallest ? smallest->rootPage : table.rootPage;
+        return plan;
+    }
+    if (smallest) {
+        useIndex(plan, AccessPath::CoveringIndexScan, table, *smallest, outputColumns, whereColumn);
+    } else {
+        plan.path = AccessPath::TableScan;
+    }
+    plan.filter = statement.hasWhere;
+    return plan;
+}
+
+// value at record position `column` | rowid is the cell key or the trailing index value
+static const Data& columnValue(const Data* values, int nValues, int column, const Data& rowid) {
+    static Data null = [] { Data data; data.type = DataType::TypeNull; return data; }();
+    if (column == ROWID_COLUMN) return rowid;
+    return column < nValues ? values[column] : null;
+}
+
+PlanCursor::PlanCursor(const QueryPlan& plan, const Data* whereValue, std::istream& db_file)
+    : plan(plan), db_file(db_file), btree(nullptr), nValues(0),
+      row(std::max<size_t>(plan.outputColumns.size(), 1)), counted(false), finished(false) {
+    rowid.type = DataType::TypeInt64;
+    // literals have no affinity of their own, they take the filtered column's | '7' finds INTEGER 7
+    where.type = DataType::TypeNull;
+    if (plan.whereColumn != NO_COLUMN) {
+        where = *whereValue;
+        if (where.type == DataType::TypeText || where.type == DataType::TypeBlob) {
+            where.value.text = strdup(whereValue->value.text);
+        }
+        applyAffinity(where, plan.whereAffinity);
+        // `column = NULL` is never true
+        finished = where.type == DataType::TypeNull;
+    }
+
+    switch (plan.path) {
+        case AccessPath::TableScan:
+        case AccessPath::CoveringIndexScan:
+            btree = new BtreeCursor(db_file, plan.rootPage);
+            break;
+        case AccessPath::IndexSeek:
+        case AccessPath::CoveringIndexSeek:
+            btree = new BtreeCursor(db_file, plan.rootPage, &where);
+            break;
+        case AccessPath::RowidSeek:
+        case AccessPath::CountBtree:
+            break;
+    }
+}
+
+PlanCursor::~PlanCursor() {
+    freeDataColumns(values, nValues);
+    freeDataColumns(&where, 1);
+    delete btree;
+}
+
+bool PlanCursor::matches() const {
+    return !plan.filter || compareData(columnValue(values, nValues, plan.whereColumn, rowid), where) == 0;
+}
+
+void PlanCursor::decodeIndexEntry(const std::string& payload) {
+    // index entries are narrow, decode them whole | the rowid is the last value
+    nValues = decodeRecord(payload, values, MAX_RECORD_COLUMNS);
+    rowid.value = DataUnion(nValues > 0 ? getIntegerValue(values[nValues - 1]) : int64_t(0));
+}
+
+bool PlanCursor::nextRecord() {
+    freeDataColumns(values, nValues);
+    nValues = 0;
+    if (finished) return false;
+
+    BtreeCell cell;
+    switch (plan.path) {
+        case AccessPath::TableScan:
+            while (btree->next(cell)) {
+                nValues = decodeRecord(cell.payload, values, plan.recordColumns);
+                rowid.value = DataUnion(static_cast<int64_t>(cell.rowid));
+                if (matches()) return true;
+                freeDataColumns(values, nValues);
+                nValues = 0;
+            }
+            break;
+        case AccessPath::RowidSeek: {
+            finished = true;
+            if (where.type == DataType::TypeText || where.type == DataType::TypeBlob) return false;
+            int64_t key = where.type == DataType::TypeFloat64 ? static_cast<int64_t>(where.value.float64)
+                                                              : getIntegerValue(where);
+            if (where.type == DataType::TypeFloat64 && key != where.value.float64) return false;
+            if (!seekTableRowid(db_file, plan.rootPage, key, cell.payload)) return false;
+            nValues = decodeRecord(cell.payload, values, plan.recordColumns);
+            rowid.value = DataUnion(key);
+            return true;
+        }
+        case AccessPath::IndexSeek:
+            while (btree->next(cell)) {
+                decodeIndexEntry(cell.payload);
+                freeDataColumns(values, nValues);
+                nValues = 0;
+                if (!seekTableRowid(db_file, plan.tableRootPage, rowid.value.int64, cell.payload)) continue;
+                nValues = decodeRecord(cell.payload, values, plan.recordColumns);
+                return true;
+            }
+            break;
+        case AccessPath::CoveringIndexSeek:
+        case AccessPath::CoveringIndexScan:
+            while (btree->next(cell)) {
+                decodeIndexEntry(cell.payload);
+                if (matches()) return true;
+                freeDataColumns(values, nValues);
+                nValues = 0;
+            }
+            break;
+        case AccessPath::CountBtree:
+            break;
+    }
+    finished = true;
+    return false;
+}
+
+bool PlanCursor::next() {
+    if (plan.countStar) {
+        if (counted) return false;
+        counted = true;
+        uint64_t count = 0;
+        if (plan.path == AccessPath::CountBtree) count = countBtreeEntries(db_file, plan.rootPage);
+        else while (nextRecord()) count++;
+        row[0].type = DataType::TypeInt64;
+        row[0].value = DataUnion(static_cast<int64_t>(count));
+        return true;
+    }
+    if (!nextRecord()) return false;
+    for (size_t i = 0; i < plan.outputColumns.size(); i++) {
+        row[i] = columnValue(values, nValues, plan.outputColumns[i], rowid);
+        // REAL columns store integral values as integers | row values share text with `values`, leave it alone
+        DataType type = row[i].type;
+        bool isInteger = type == DataType::TypeInt8 || type == DataType::TypeInt16 ||
+                         type == DataType::TypeInt32 || type == DataType::TypeInt64;
+        if (plan.outputAffinities[i] == Affinity::Real && isInteger) {
+            row[i].value = DataUnion(static_cast<double>(getIntegerValue(row[i])));
+            row[i].type = DataType::TypeFloat64;
+        }
+    }
+    return true;
+}
+
+const Data* PlanCursor::getRow() const {
+    return row.data();
+}
+
+int PlanCursor::getColumnCount() const {
+    return plan.countStar ? 1 : plan.outputColumns.size();
+}
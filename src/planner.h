@@ -0,0 +1,92 @@
+#ifndef PLANNER_H
+#define PLANNER_H
+
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+#include "btree.h"
+#include "schema.h"
+#include "utility.h"
+
+// column position meaning "the rowid" | the cell key on table pages, the last value of an index entry
+#define ROWID_COLUMN -1
+// column position of something that isn't there | no WHERE, a column missing from an index
+#define NO_COLUMN -2
+
+// SELECT COUNT(*) | column, ... FROM table [WHERE column = literal | ?]
+struct SelectStatement {
+    bool countStar;
+    std::vector<std::string> columns;  // empty for COUNT(*)
+    std::string table;
+    bool hasWhere;
+    std::string whereColumn;
+    Data whereValue;
+};
+
+enum class AccessPath {
+    TableScan,          // every row of the table b-tree
+    RowidSeek,          // WHERE on the INTEGER PRIMARY KEY
+    IndexSeek,          // index entries for the key, then each row by rowid
+    CoveringIndexSeek,  // index entries for the key answer the query on their own
+    CoveringIndexScan,  // every index entry | the index is narrower than the table
+    CountBtree          // unfiltered COUNT(*) from the b-tree with the fewest pages
+};
+
+struct QueryPlan {
+    AccessPath path;
+    bool countStar;
+    uint32_t rootPage;                // b-tree the plan starts from
+    uint32_t tableRootPage;           // table b-tree for rowid lookups
+    int whereColumn;                  // record position of the filter column | ROWID_COLUMN, NO_COLUMN
+    Affinity whereAffinity;           // applied to the WHERE operand before seeking or comparing
+    bool filter;                      // compare `whereColumn` against the value for every row
+    std::vector<int> outputColumns;   // record positions of the selected columns | ROWID_COLUMN
+    std::vector<Affinity> outputAffinities;  // affinity of each selected column
+    int recordColumns;                // values to decode from each table record
+};
+
+// parse a literal token into `value` | text is malloc'ed and owned by the caller
+void parseLiteral(const std::string& token, Data& value);
+
+// parse `sql` into `statement` | throws on anything outside the supported subset
+// the WHERE operand may be a `?` parameter, left as NULL in `whereValue`
+bool parseSelect(const std::string& sql, SelectStatement& statement);
+
+// choose how to answer `statement` against `table`
+QueryPlan planSelect(const SelectStatement& statement, const TableSchema& table, std::istream& db_file);
+
+// Produces the result rows of a plan one at a time, reading pages only as rows are asked for.
+class PlanCursor {
+public:
+    // `plan` and `db_file` must outlive the cursor | `whereValue` is copied, nullptr when there is no WHERE
+    PlanCursor(const QueryPlan& plan, const Data* whereValue, std::istream& db_file);
+    ~PlanCursor();
+    PlanCursor(const PlanCursor&) = delete;
+    PlanCursor& operator=(const PlanCursor&) = delete;
+
+    // advance to the next result row | false once every row was returned
+    bool next();
+    // values of the current row | valid until the next call to next
+    const Data* getRow() const;
+    int getColumnCount() const;
+
+private:
+    // decode the next record that passes the filter into `values` | false at the end
+    bool nextRecord();
+    bool matches() const;
+    void decodeIndexEntry(const std::string& payload);
+
+    const QueryPlan& plan;
+    std::istream& db_file;
+    Data where;           // WHERE operand with the column affinity applied
+    BtreeCursor* btree;   // nullptr for rowid seeks and COUNT(*) from page headers
+    Data values[MAX_RECORD_COLUMNS];
+    int nValues;
+    Data rowid;
+    std::vector<Data> row;  // a select list may repeat columns, so it can be wider than any record
+    bool counted;
+    bool finished;
+};
+
+#endif // PLANNER_H
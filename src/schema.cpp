@@ -0,0 +1,201 @@
+#include "schema.h"
+#include <cstring>
+#include "btree.h"
+
+bool readSqliteSchema(DataTable *table, std::istream& db_file) {
+    // sqlite_schema is the table b-tree rooted at page 1
+    scanTableBtree(db_file, 1, [&](varint rowid, const std::string& payload) {
+        Data data[SCHEMA_COLUMNS];
+        int nColumns = decodeRecord(payload, data, SCHEMA_COLUMNS);
+        for (int i = nColumns; i < SCHEMA_COLUMNS; i++) data[i].type = DataType::TypeNull;
+        addRow(table, data, SCHEMA_COLUMNS);
+        return true;
+    });
+    return true;
+}
+
+// split the comma separated definitions between the parenthesis at `tokens[start]` and its match
+// returns the position after the closing parenthesis | 0 when there is none
+static size_t splitDefinitions(const std::string* tokens, size_t nTokens, size_t start,
+                               std::vector<std::vector<std::string>>& definitions) {
+    int depth = 0;
+    definitions.emplace_back();
+    for (size_t i = start; i < nTokens; i++) {
+        const std::string& token = tokens[i];
+        if (token == "(" && depth++ == 0) continue;
+        if (token == ")" && --depth == 0) return i + 1;
+        if (token == "," && depth == 1) {
+            definitions.emplace_back();
+            continue;
+        }
+        definitions.back().push_back(token);
+    }
+    return 0;
+}
+
+static size_t findToken(const std::string* tokens, size_t nTokens, size_t start, const char* token) {
+    for (size_t i = start; i < nTokens; i++) {
+        if (equalsIgnoreCase(tokens[i], token)) return i;
+    }
+    return nTokens;
+}
+
+Affinity resolveAffinity(const std::string& declaredType) {
+    std::string type = declaredType;
+    for (char& c : type) c = toupper(static_cast<unsigned char>(c));
+    // the first rule that matches a substring of the type wins
+    if (type.find("INT") != std::string::npos) return Affinity::Integer;
+    if (type.find("CHAR") != std::string::npos || type.find("CLOB") != std::string::npos ||
+        type.find("TEXT") != std::string::npos) {
+        return Affinity::Text;
+    }
+    if (type.empty() || type.find("BLOB") != std::string::npos) return Affinity::Blob;
+    if (type.find("REAL") != std::string::npos || type.find("FLOA") != std::string::npos ||
+        type.find("DOUB") != std::string::npos) {
+        return Affinity::Real;
+    }
+    return Affinity::Numeric;
+}
+
+// declared type of a column definition | the tokens between the name and the first constraint
+static std::string declaredType(const std::vector<std::string>& definition) {
+    static const char* constraints[] = {"CONSTRAINT", "PRIMARY", "NOT", "NULL", "UNIQUE", "CHECK",
+                                        "DEFAULT", "COLLATE", "REFERENCES", "GENERATED", "AS"};
+    std::string type;
+    for (size_t i = 1; i < definition.size(); i++) {
+        for (const char* constraint : constraints) {
+            if (equalsIgnoreCase(definition[i], constraint)) return type;
+        }
+        if (!type.empty()) type += ' ';
+        type += definition[i];
+    }
+    return type;
+}
+
+bool parseCreateTable(const std::string& sql, TableSchema& table) {
+    DynamicArray tokens;
+    tokenizeSql(sql, tokens);
+    const std::string* data = tokens.getData();
+    size_t nTokens = tokens.getSize();
+
+    size_t open = findToken(data, nTokens, 0, "(");
+    std::vector<std::vector<std::string>> definitions;
+    size_t end = splitDefinitions(data, nTokens, open, definitions);
+    if (open == nTokens || end == 0) return false;
+    // WITHOUT ROWID tables are stored as index b-trees
+    if (findToken(data, nTokens, end, "WITHOUT") != nTokens) return false;
+
+    table.columns.clear();
+    table.affinities.clear();
+    table.rowidAlias = -1;
+    std::vector<bool> integerColumns;
+    for (const std::vector<std::string>& definition : definitions) {
+        if (definition.empty()) continue;
+        const std::string& first = definition[0];
+        // table constraints
+        if (equalsIgnoreCase(first, "PRIMARY")) {
+            // PRIMARY KEY(column) on a single INTEGER column makes it a rowid alias
+            if (definition.size() == 5 && definition[2] == "(" && definition[4] == ")") {
+                for (size_t i = 0; i < table.columns.size(); i++) {
+                    if (equalsIgnoreCase(table.columns[i], definition[3]) && integerColumns[i]) {
+                        table.rowidAlias = i;
+                    }
+                }
+            }
+            continue;
+        }
+        if (equalsIgnoreCase(first, "CONSTRAINT") || equalsIgnoreCase(first, "UNIQUE") ||
+            equalsIgnoreCase(first, "CHECK") || equalsIgnoreCase(first, "FOREIGN")) {
+            continue;
+        }
+
+        bool isInteger = definition.size() > 1 && equalsIgnoreCase(definition[1], "INTEGER");
+        size_t primary = findToken(definition.data(), definition.size(), 1, "PRIMARY");
+        bool isPrimaryKey = primary + 1 < definition.size() && equalsIgnoreCase(definition[primary + 1], "KEY");
+        bool isDesc = primary + 2 < definition.size() && equalsIgnoreCase(definition[primary + 2], "DESC");
+        if (isInteger && isPrimaryKey && !isDesc) table.rowidAlias = table.columns.size();
+        table.columns.push_back(first);
+        table.affinities.push_back(resolveAffinity(declaredType(definition)));
+        integerColumns.push_back(isInteger);
+    }
+    return !table.columns.empty();
+}
+
+bool parseCreateIndex(const std::string& sql, IndexSchema& index) {
+    DynamicArray tokens;
+    tokenizeSql(sql, tokens);
+    const std::string* data = tokens.getData();
+    size_t nTokens = tokens.getSize();
+
+    size_t on = findToken(data, nTokens, 0, "ON");
+    size_t open = findToken(data, nTokens, on, "(");
+    std::vector<std::vector<std::string>> definitions;
+    size_t end = splitDefinitions(data, nTokens, open, definitions);
+    if (on == nTokens || open == nTokens || end == 0) return false;
+
+    index.columns.clear();
+    index.usable = true;
+    index.seekable = true;
+    for (size_t i = 0; i < definitions.size(); i++) {
+        const std::vector<std::string>& definition = definitions[i];
+        if (definition.empty() || definition[0] == "(") {
+            index.usable = false;
+            continue;
+        }
+        // column [COLLATE name] [ASC | DESC] | anything else is an expression
+        bool binary = true, desc = false;
+        for (size_t j = 1; j < definition.size(); j++) {
+            if (equalsIgnoreCase(definition[j], "COLLATE") && j + 1 < definition.size()) {
+                binary = equalsIgnoreCase(definition[++j], "BINARY");
+            }
+            else if (equalsIgnoreCase(definition[j], "DESC")) desc = true;
+            else if (!equalsIgnoreCase(definition[j], "ASC")) index.usable = false;
+        }
+        if (i == 0) index.seekable = binary && !desc;
+        index.columns.push_back(definition[0]);
+    }
+    // partial indexes don't hold every row
+    if (findToken(data, nTokens, end, "WHERE") != nTokens) index.usable = false;
+    return !index.columns.empty();
+}
+
+uint32_t readSchemaCookie(std::istream& db_file) {
+    db_file.clear();
+    db_file.seekg(40);
+    return read4ByteInt(db_file);
+}
+
+bool loadTableSchema(const std::string& tableName, std::istream& db_file, TableSchema& table) {
+    DataTable schema;
+    initDataTable(&schema);
+    readSqliteSchema(&schema, db_file);
+
+    bool found = false;
+    table.indexes.clear();
+    for (int i = 0; i < schema.num_rows; ++i) {
+        Data* columns = schema.rows[i].columns;
+        // auto indexes have no sql
+        if (columns[SCHEMA_TYPE].type != DataType::TypeText || columns[SCHEMA_TBL_NAME].type != DataType::TypeText ||
+            columns[SCHEMA_SQL].type != DataType::TypeText) {
+            continue;
+        }
+        if (!equalsIgnoreCase(columns[SCHEMA_TBL_NAME].value.text, tableName)) continue;
+
+        uint32_t rootPage = getIntegerValue(columns[SCHEMA_ROOTPAGE]);
+        if (strcmp(columns[SCHEMA_TYPE].value.text, "table") == 0) {
+            table.name = columns[SCHEMA_NAME].value.text;
+            table.rootPage = rootPage;
+            found = parseCreateTable(columns[SCHEMA_SQL].value.text, table);
+        }
+        else if (strcmp(columns[SCHEMA_TYPE].value.text, "index") == 0) {
+            IndexSchema index;
+            index.name = columns[SCHEMA_NAME].value.text;
+            index.rootPage = rootPage;
+            if (parseCreateIndex(columns[SCHEMA_SQL].value.text, index) && index.usable) {
+                table.indexes.push_back(index);
+            }
+        }
+    }
+    freeDataTable(&schema);
+    return found;
+}
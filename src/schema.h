@@ -0,0 +1,61 @@
+#ifndef SCHEMA_H
+#define SCHEMA_H
+
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+#include "utility.h"
+
+/**
+ * CREATE TABLE sqlite_schema(
+        type text,
+        name text,
+        tbl_name text,
+        rootpage integer,
+        sql text
+    );
+    */
+#define SCHEMA_TYPE 0
+#define SCHEMA_NAME 1
+#define SCHEMA_TBL_NAME 2
+#define SCHEMA_ROOTPAGE 3
+#define SCHEMA_SQL 4
+#define SCHEMA_COLUMNS 5
+
+struct IndexSchema {
+    std::string name;
+    uint32_t rootPage;
+    std::vector<std::string> columns;  // key columns in index order | the rowid follows them in every entry
+    bool seekable;                     // first column is ascending with BINARY collation
+    bool usable;                       // plain column index | no expressions, not partial
+};
+
+struct TableSchema {
+    std::string name;
+    uint32_t rootPage;
+    std::vector<std::string> columns;  // in record order
+    std::vector<Affinity> affinities;  // affinity of each column's declared type
+    int rowidAlias;                    // column that is an INTEGER PRIMARY KEY | -1 when there is none
+    std::vector<IndexSchema> indexes;
+};
+
+// read from `db_file` stream, db table's info from sqlite_schema into DataTable
+// see schema definiton of sqlite_schema for more information
+bool readSqliteSchema(DataTable *table, std::istream& db_file);
+
+// affinity of a column declared with `declaredType` | "" when it has no type
+Affinity resolveAffinity(const std::string& declaredType);
+
+// parse the column list of a `CREATE TABLE` statement
+bool parseCreateTable(const std::string& sql, TableSchema& table);
+// parse the key columns of a `CREATE INDEX` statement
+bool parseCreateIndex(const std::string& sql, IndexSchema& index);
+
+// schema cookie | 4-byte big-endian integer at offset 40, bumped on every schema change
+uint32_t readSchemaCookie(std::istream& db_file);
+
+// resolve table `tableName` and every index on it from sqlite_schema
+bool loadTableSchema(const std::string& tableName, std::istream& db_file, TableSchema& table);
+
+#endif // SCHEMA_H
@@ -0,0 +1,188 @@
+#include "statement.h"
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include "schema.h"
+
+PlanCache* PlanCache::instance = nullptr;
+
+PlanCache::PlanCache() : capacity(DEFAULT_PLAN_CACHE_SIZE), schemaCookie(0) {}
+
+PlanCache* PlanCache::getInstance() {
+    if (instance == nullptr) {
+        instance = new PlanCache();
+    }
+    return instance;
+}
+
+const CachedPlan* PlanCache::get(const std::string& key, uint32_t cookie) {
+    // plans resolved against an older schema may point at dropped b-trees
+    if (cookie != schemaCookie) {
+        clear();
+        schemaCookie = cookie;
+    }
+    auto it = lookup.find(key);
+    if (it == lookup.end()) return nullptr;
+    entries.splice(entries.begin(), entries, it->second);
+    return &it->second->second;
+}
+
+void PlanCache::put(const std::string& key, const CachedPlan& plan) {
+    if (capacity == 0) return;
+    auto it = lookup.find(key);
+    if (it != lookup.end()) {
+        it->second->second = plan;
+        entries.splice(entries.begin(), entries, it->second);
+        return;
+    }
+    entries.emplace_front(key, plan);
+    lookup[key] = entries.begin();
+    if (entries.size() > capacity) {
+        lookup.erase(entries.back().first);
+        entries.pop_back();
+    }
+}
+
+void PlanCache::clear() {
+    entries.clear();
+    lookup.clear();
+}
+
+std::string normalizeSql(const std::string& sql, std::vector<Data>& literals) {
+    DynamicArray tokens;
+    tokenizeSql(sql, tokens);
+    const std::string* data = tokens.getData();
+    size_t nTokens = tokens.getSize();
+
+    // the WHERE operand is the only literal parseSelect accepts | anything literal looking elsewhere
+    // is an identifier, e.g. "2020" once tokenizeSql stripped its quotes
+    size_t end = nTokens > 0 && data[nTokens - 1] == ";" ? nTokens - 1 : nTokens;
+    size_t operand = end >= 4 && equalsIgnoreCase(data[end - 4], "WHERE") && data[end - 2] == "=" ? end - 1 : nTokens;
+
+    std::string normalized;
+    for (size_t i = 0; i < nTokens; i++) {
+        if (i > 0) normalized += ' ';
+        if (i == operand) {
+            Data value;
+            value.type = DataType::TypeNull;
+            if (data[i] != "?") parseLiteral(data[i], value);
+            literals.push_back(value);
+            normalized += '?';
+            continue;
+        }
+        // keywords and identifiers are case insensitive | keep unquoted identifiers with spaces apart
+        std::string token = data[i];
+        for (char& c : token) c = tolower(static_cast<unsigned char>(c));
+        if (token.empty() || token.find_first_of(" \t\r\n") != std::string::npos) token = "\"" + token + "\"";
+        normalized += token;
+    }
+    return normalized;
+}
+
+PreparedStatement::PreparedStatement(const CachedPlan& cached, uint32_t schemaCookie, std::istream& db_file)
+    : plan(cached.plan), schemaCookie(schemaCookie), db_file(db_file), parameters(cached.parameterCount),
+      cursor(nullptr) {
+    for (Data& parameter : parameters) parameter.type = DataType::TypeNull;
+}
+
+PreparedStatement::~PreparedStatement() {
+    delete cursor;
+    freeDataColumns(parameters.data(), parameters.size());
+}
+
+int PreparedStatement::getParameterCount() const {
+    return parameters.size();
+}
+
+void PreparedStatement::bind(int index, const Data& value) {
+    if (index < 1 || index > static_cast<int>(parameters.size())) {
+        throw std::out_of_range("Parameter index out of range.");
+    }
+    // the running cursor holds its own copy of the WHERE operand
+    if (cursor != nullptr) throw std::logic_error("Reset the statement before binding.");
+    Data& parameter = parameters[index - 1];
+    freeDataColumns(&parameter, 1);
+    parameter = value;
+    if (value.type == DataType::TypeText || value.type == DataType::TypeBlob) {
+        parameter.value.text = strdup(value.value.text);
+    }
+}
+
+bool PreparedStatement::step() {
+    if (cursor == nullptr) {
+        // the WHERE operand is the only place a parameter can appear
+        cursor = new PlanCursor(plan, plan.whereColumn != NO_COLUMN ? &parameters[0] : nullptr, db_file);
+    }
+    return cursor->next();
+}
+
+const Data* PreparedStatement::getRow() const {
+    if (cursor == nullptr) throw std::out_of_range("No current row.");
+    return cursor->getRow();
+}
+
+int PreparedStatement::getColumnCount() const {
+    return plan.countStar ? 1 : plan.outputColumns.size();
+}
+
+void PreparedStatement::reset() {
+    delete cursor;
+    cursor = nullptr;
+}
+
+bool PreparedStatement::isExpired() const {
+    return readSchemaCookie(db_file) != schemaCookie;
+}
+
+void PreparedStatement::execute(std::ostream& out) {
+    reset();
+    int numColumns = getColumnCount();
+    while (step()) {
+        const Data* row = getRow();
+        std::ostringstream line;
+        for (int i = 0; i < numColumns; i++) {
+            if (i > 0) line << '|';
+            printData(line, row[i]);
+        }
+        line << '\n';
+        out << line.str();
+    }
+    reset();
+}
+
+PreparedStatement* prepare(const std::string& sql, std::istream& db_file) {
+    std::vector<Data> literals;
+    std::string key = normalizeSql(sql, literals);
+
+    PlanCache* cache = PlanCache::getInstance();
+    uint32_t schemaCookie = readSchemaCookie(db_file);
+    const CachedPlan* cached = cache->get(key, schemaCookie);
+    CachedPlan resolved;
+    if (cached == nullptr) {
+        try {
+            SelectStatement statement;
+            parseSelect(sql, statement);
+            freeDataColumns(&statement.whereValue, 1);
+
+            // resolve the table and its indexes from sqlite_schema
+            TableSchema table;
+            if (!loadTableSchema(statement.table, db_file, table)) {
+                throw std::invalid_argument("no such table: " + statement.table);
+            }
+            resolved.plan = planSelect(statement, table, db_file);
+            resolved.parameterCount = literals.size();
+        } catch (...) {
+            freeDataColumns(literals.data(), literals.size());
+            throw;
+        }
+        cache->put(key, resolved);
+        cached = &resolved;
+    }
+
+    PreparedStatement* statement = new PreparedStatement(*cached, schemaCookie, db_file);
+    for (size_t i = 0; i < literals.size(); i++) {
+        statement->bind(i + 1, literals[i]);
+    }
+    freeDataColumns(literals.data(), literals.size());
+    return statement;
+}
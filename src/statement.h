@@ -0,0 +1,82 @@
+#ifndef STATEMENT_H
+#define STATEMENT_H
+
+#include <cstdint>
+#include <istream>
+#include <list>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "planner.h"
+#include "utility.h"
+
+#define DEFAULT_PLAN_CACHE_SIZE 64
+
+// a resolved plan | root pages, access path and column positions, but no literal values
+struct CachedPlan {
+    QueryPlan plan;
+    int parameterCount;
+};
+
+// Bounded LRU cache of plans keyed by normalized SQL.
+// Every plan was resolved against one schema, the whole cache is dropped when the schema cookie moves.
+class PlanCache {
+private:
+    static PlanCache* instance;
+    size_t capacity;
+    uint32_t schemaCookie;
+    std::list<std::pair<std::string, CachedPlan>> entries;  // most recently used first
+    std::unordered_map<std::string, std::list<std::pair<std::string, CachedPlan>>::iterator> lookup;
+
+    PlanCache();  // Private constructor.
+    PlanCache(const PlanCache&) = delete;  // Prevent copying.
+    PlanCache& operator=(const PlanCache&) = delete;  // Prevent assignment.
+
+public:
+    static PlanCache* getInstance();
+    // plan cached for `key` under `cookie` | nullptr on a miss, valid until the next put
+    const CachedPlan* get(const std::string& key, uint32_t cookie);
+    void put(const std::string& key, const CachedPlan& plan);
+    void clear();
+};
+
+// replace the WHERE operand of `sql` with `?`, appending its value to `literals`
+// statements differing only in literal values normalize to the same string
+std::string normalizeSql(const std::string& sql, std::vector<Data>& literals);
+
+class PreparedStatement {
+public:
+    PreparedStatement(const CachedPlan& cached, uint32_t schemaCookie, std::istream& db_file);
+    ~PreparedStatement();
+    PreparedStatement(const PreparedStatement&) = delete;
+    PreparedStatement& operator=(const PreparedStatement&) = delete;
+
+    int getParameterCount() const;
+    // bind `value` to parameter `index` (1 based) | text is copied, throws while rows are being stepped
+    void bind(int index, const Data& value);
+    // advance to the next result row, reading only the pages it needs | false once every row was returned
+    bool step();
+    // values of the current row | valid until the next step or reset
+    const Data* getRow() const;
+    int getColumnCount() const;
+    // rewind so the next step runs the statement again with the current bindings
+    void reset();
+    // the schema changed since the plan was resolved | prepare the statement again
+    bool isExpired() const;
+    // run the statement from the start, writing rows the way the sqlite3 shell does
+    void execute(std::ostream& out);
+
+private:
+    QueryPlan plan;
+    uint32_t schemaCookie;
+    std::istream& db_file;
+    std::vector<Data> parameters;
+    PlanCursor* cursor;  // created by the first step after a reset
+};
+
+// compile `sql` against the database in `db_file`, reusing a cached plan when the shape was seen before
+// literals in `sql` come pre-bound as parameters | throws on unsupported SQL or unknown tables
+PreparedStatement* prepare(const std::string& sql, std::istream& db_file);
+
+#endif // STATEMENT_H
@@ -2,6 +2,9 @@
 #include <iostream>
 #include <sstream>
 #include <typeinfo>
+#include <cstring>
+#include <cerrno>
+#include <type_traits>
 #include "config.h"
 
 void* getDataValue(Data &data) {
@@ -29,11 +32,13 @@ DataType resolveSerialType(varint serialType) {
         case 0: return DataType::TypeNull;
         case 1: return DataType::TypeInt8;
         case 2: return DataType::TypeInt16;
+        case 3:
         case 4: return DataType::TypeInt32;
+        case 5:
         case 6: return DataType::TypeInt64;
         case 7: return DataType::TypeFloat64;
         case 8:
-        case 9: return DataType::Unsupported;  // Special handling for fixed integers:: integer 0 | integer 1
+        case 9: return DataType::TypeInt8;  // fixed integers:: integer 0 | integer 1, no body bytes
         default:
             if (serialType >= 12 && serialType % 2 == 0)
                 return DataType::TypeBlob;
@@ -45,6 +50,28 @@ DataType resolveSerialType(varint serialType) {
 
 Data processBySerialType(varint serialType, std::istream& stream) {
     DataType dataType = resolveSerialType(serialType);
+    // odd sized integers and the constants 0 / 1 don't map onto a C type
+    switch (serialType) {
+        case 3: {
+            Data data;
+            data.type = dataType;
+            data.value = DataUnion(static_cast<int32_t>(readBigEndianInt(stream, 3)));
+            return data;
+        }
+        case 5: {
+            Data data;
+            data.type = dataType;
+            data.value = DataUnion(static_cast<int64_t>(readBigEndianInt(stream, 6)));
+            return data;
+        }
+        case 8:
+        case 9: {
+            Data data;
+            data.type = dataType;
+            data.value = DataUnion(static_cast<int8_t>(serialType - 8));
+            return data;
+        }
+    }
     switch (dataType) {
         case DataType::TypeInt8:
             return processData<int8_t>(stream, dataType);
@@ -70,10 +97,12 @@ Data processBySerialType(varint serialType, std::istream& stream) {
         }
         case DataType::TypeText: {
             int nBytes = (serialType - 13) / 2;
-            char* text = new char[nBytes + 1];  // +1 for null terminator
             SQLiteEncoding textEncoding = Config::getInstance()->getTextEncoding();
-            readText(text, nBytes, textEncoding, stream);
-            text[nBytes] = '\0';  // Ensure null termination
+            // a UTF-16 code unit becomes at most 3 UTF-8 bytes
+            size_t capacity = textEncoding == SQLiteEncoding::SQLITE_UTF8 ? nBytes : nBytes / 2 * 3;
+            char* text = (char*) malloc(capacity + 1);  // +1 for null terminator | released with free()
+            size_t length = readText(text, nBytes, textEncoding, stream);
+            text[length] = '\0';  // Ensure null termination
 
             Data data;
             data.type = DataType::TypeText;
@@ -81,31 +110,307 @@ Data processBySerialType(varint serialType, std::istream& stream) {
             return data;
             break;
         }
-        case DataType::TypeBlob:
+        case DataType::TypeBlob: {
+            // blobs are kept as raw bytes in the text slot; callers that need the length
+            // must keep the serial type around
+            int nBytes = (serialType - 12) / 2;
+            char* blob = (char*) malloc(nBytes + 1);
+            stream.read(blob, nBytes);
+            blob[nBytes] = '\0';
+
+            Data data;
+            data.type = DataType::TypeBlob;
+            data.value.text = blob;
+            return data;
+            break;
+        }
         case DataType::Unsupported:
         default:
             throw std::invalid_argument("Unsupported data type for processing.");
     }
 }
 
+// read a `nBytes` wide big-endian two's complement integer from current read position of `stream`
+int64_t readBigEndianInt(std::istream& stream, int nBytes) {
+    unsigned char buffer[8];
+    if (!stream.read(reinterpret_cast<char*>(buffer), nBytes)) {
+        throw std::runtime_error("Failed to read data from stream.");
+    }
+    uint64_t value = (buffer[0] & 0x80) ? ~uint64_t(0) : 0;  // sign extend
+    for (int i = 0; i < nBytes; i++) {
+        value = (value << 8) | buffer[i];
+    }
+    return static_cast<int64_t>(value);
+}
+
 template<typename T>
 Data processData(std::istream& stream, DataType type) {
+    // record values are stored big-endian
+    int64_t raw = readBigEndianInt(stream, sizeof(T));
     T value;
-    if (stream.read(reinterpret_cast<char*>(&value), sizeof(T))) {
-        Data data;
-        data.type = type;
-        switch (type) {
-            case DataType::TypeInt8: data.value = DataUnion(static_cast<int8_t>(value)); break;
-            case DataType::TypeInt16: data.value = DataUnion(static_cast<int16_t>(value)); break;
-            case DataType::TypeInt32: data.value = DataUnion(static_cast<int32_t>(value)); break;
-            case DataType::TypeInt64: data.value = DataUnion(static_cast<int64_t>(value)); break;
-            case DataType::TypeFloat64: data.value = DataUnion(static_cast<double>(value)); break;
-            default:
-                throw std::runtime_error("Invalid data type for union initialization");
-        }
-        return data;
+    if constexpr (std::is_floating_point_v<T>) {
+        std::memcpy(&value, &raw, sizeof(T));
     } else {
-        throw std::runtime_error("Failed to read data from stream.");
+        value = static_cast<T>(raw);
+    }
+    Data data;
+    data.type = type;
+    switch (type) {
+        case DataType::TypeInt8: data.value = DataUnion(static_cast<int8_t>(value)); break;
+        case DataType::TypeInt16: data.value = DataUnion(static_cast<int16_t>(value)); break;
+        case DataType::TypeInt32: data.value = DataUnion(static_cast<int32_t>(value)); break;
+        case DataType::TypeInt64: data.value = DataUnion(static_cast<int64_t>(value)); break;
+        case DataType::TypeFloat64: data.value = DataUnion(static_cast<double>(value)); break;
+        default:
+            throw std::runtime_error("Invalid data type for union initialization");
+    }
+    return data;
+}
+
+varint readVarint(std::istream& stream) {
+    varint value = 0;
+    char buffer;
+    int pos = 0;
+    while (pos++ < 9) {
+        stream.read(&buffer, 1);
+        if (stream.gcount() != 1) {
+            throw std::runtime_error("Failed to read 1 byte from stream.");
+        }
+        unsigned short byte = static_cast<unsigned char>(buffer);
+        if(pos == 9) {
+            value <<= 8;    
+            value |= byte;
+            continue;
+        }
+        value <<= 7;
+        value |= byte & 0x7F;
+        if ((byte & 0x80) == 0) break; // MSB is not set. Last Byte
+    }
+    return value;
+}
+
+varint readVarint(const char* buffer, int* nBytes) {
+    varint value = 0;
+    int pos = 0;
+    while (pos < 9) {
+        unsigned short byte = static_cast<unsigned char>(buffer[pos++]);
+        if(pos == 9) {
+            value <<= 8;
+            value |= byte;
+            break;
+        }
+        value <<= 7;
+        value |= byte & 0x7F;
+        if ((byte & 0x80) == 0) break; // MSB is not set. Last Byte
+    }
+    *nBytes = pos;
+    return value;
+}
+
+uint32_t read4ByteInt(std::istream& stream) {
+    char buffer[4];
+    stream.read(buffer, 4);
+    if (stream.gcount() != 4) {
+        throw std::runtime_error("Failed to read 4 bytes from stream.");
+    }
+    return read4ByteInt(buffer);
+}
+
+unsigned short read2ByteInt(const char* buffer) {
+    return (static_cast<unsigned char>(buffer[1]) | (static_cast<unsigned char>(buffer[0]) << 8));
+}
+
+uint32_t read4ByteInt(const char* buffer) {
+    return (static_cast<unsigned char>(buffer[0]) << 24) |
+           (static_cast<unsigned char>(buffer[1]) << 16) |
+           (static_cast<unsigned char>(buffer[2]) << 8) |
+            static_cast<unsigned char>(buffer[3]);
+}
+
+int decodeRecord(const std::string& payload, Data* columns, int maxColumns) {
+    std::istringstream payload_stream(payload);
+    // record header size | includes the size varint itself
+    varint nbytes_record_header = readVarint(payload_stream);
+
+    // Serial Type Codes
+    varint serialTypes[MAX_RECORD_COLUMNS];
+    int nSerialTypes = 0;
+    while (payload_stream.tellg() < nbytes_record_header && nSerialTypes < maxColumns) {
+        if (nSerialTypes == MAX_RECORD_COLUMNS) {
+            throw std::runtime_error("Record has more columns than supported.");
+        }
+        serialTypes[nSerialTypes++] = readVarint(payload_stream);
+    }
+
+    // Record body
+    payload_stream.seekg(nbytes_record_header);
+    for (int i = 0; i < nSerialTypes; i++) {
+        columns[i] = processBySerialType(serialTypes[i], payload_stream);
+    }
+    return nSerialTypes;
+}
+
+void freeDataColumns(Data* columns, int numColumns) {
+    for (int i = 0; i < numColumns; i++) {
+        if (columns[i].type == DataType::TypeText || columns[i].type == DataType::TypeBlob) {
+            free(columns[i].value.text);
+            columns[i].type = DataType::TypeNull;
+        }
+    }
+}
+
+int64_t getIntegerValue(const Data& data) {
+    switch (data.type) {
+        case DataType::TypeInt8: return data.value.int8;
+        case DataType::TypeInt16: return data.value.int16;
+        case DataType::TypeInt32: return data.value.int32;
+        case DataType::TypeInt64: return data.value.int64;
+        default: return 0;
+    }
+}
+
+// storage class rank used by index ordering
+static int storageClass(const Data& data) {
+    switch (data.type) {
+        case DataType::TypeNull: return 0;
+        case DataType::TypeText: return 2;
+        case DataType::TypeBlob: return 3;
+        default: return 1;
+    }
+}
+
+// UTF-8 `text` re-encoded as UTF-16 in the byte order of `textEncoding`
+static std::string encodeUtf16(const char* text, SQLiteEncoding textEncoding) {
+    bool bigEndian = textEncoding == SQLiteEncoding::SQLITE_UTF16BE;
+    std::string out;
+    auto append = [&](uint32_t unit) {
+        out += static_cast<char>(bigEndian ? unit >> 8 : unit & 0xFF);
+        out += static_cast<char>(bigEndian ? unit & 0xFF : unit >> 8);
+    };
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(text);
+    while (*p) {
+        uint32_t codePoint = *p++;
+        int continuation = codePoint >= 0xF0 ? 3 : codePoint >= 0xE0 ? 2 : codePoint >= 0xC0 ? 1 : 0;
+        if (continuation) codePoint &= 0x3F >> continuation;
+        for (; continuation > 0 && (*p & 0xC0) == 0x80; continuation--) codePoint = (codePoint << 6) | (*p++ & 0x3F);
+        if (codePoint >= 0x10000) {
+            codePoint -= 0x10000;
+            append(0xD800 + (codePoint >> 10));
+            append(0xDC00 + (codePoint & 0x3FF));
+        } else {
+            append(codePoint);
+        }
+    }
+    return out;
+}
+
+// BINARY collation is memcmp over the text as stored, which for UTF-16 isn't the order of the UTF-8 we decode to
+static int compareText(const char* a, const char* b) {
+    SQLiteEncoding textEncoding = Config::getInstance()->getTextEncoding();
+    if (textEncoding == SQLiteEncoding::SQLITE_UTF8) return strcmp(a, b);
+    std::string x = encodeUtf16(a, textEncoding), y = encodeUtf16(b, textEncoding);
+    return x.compare(y);
+}
+
+int compareData(const Data& a, const Data& b) {
+    int classA = storageClass(a), classB = storageClass(b);
+    if (classA != classB) return classA - classB;
+    switch (classA) {
+        case 0: return 0;
+        case 1: {
+            if (a.type != DataType::TypeFloat64 && b.type != DataType::TypeFloat64) {
+                int64_t x = getIntegerValue(a), y = getIntegerValue(b);
+                return (x > y) - (x < y);
+            }
+            double x = a.type == DataType::TypeFloat64 ? a.value.float64 : getIntegerValue(a);
+            double y = b.type == DataType::TypeFloat64 ? b.value.float64 : getIntegerValue(b);
+            return (x > y) - (x < y);
+        }
+        case 2:
+            return compareText(a.value.text, b.value.text);
+        default:
+            return strcmp(a.value.text, b.value.text);
+    }
+}
+
+void printData(std::ostream& out, const Data& data) {
+    switch (data.type) {
+        case DataType::TypeNull:
+            break;
+        case DataType::TypeFloat64: {
+            std::ostringstream ss;
+            ss.precision(15);
+            ss << data.value.float64;
+            std::string str = ss.str();
+            // sqlite3 always shows a REAL with a decimal point
+            if (str.find_first_of(".einf") == std::string::npos) str += ".0";
+            out << str;
+            break;
+        }
+        case DataType::TypeText:
+        case DataType::TypeBlob:
+            out << data.value.text;
+            break;
+        default:
+            out << getIntegerValue(data);
+    }
+}
+
+// parse `text` as an integer or a real the way SQLite recognizes a numeric string
+static bool parseNumeric(const char* text, Data& data) {
+    std::string str(text);
+    size_t first = str.find_first_not_of(" \t\r\n"), last = str.find_last_not_of(" \t\r\n");
+    if (first == std::string::npos) return false;
+    str = str.substr(first, last - first + 1);
+    // strtod also takes hex, inf and nan
+    if (str.find_first_not_of("0123456789+-.eE") != std::string::npos) return false;
+
+    char* end = nullptr;
+    errno = 0;
+    long long integer = strtoll(str.c_str(), &end, 10);
+    if (*end == '\0' && errno == 0) {
+        data.type = DataType::TypeInt64;
+        data.value = DataUnion(static_cast<int64_t>(integer));
+        return true;
+    }
+    double real = strtod(str.c_str(), &end);
+    if (*end != '\0') return false;
+    data.type = DataType::TypeFloat64;
+    data.value = DataUnion(real);
+    return true;
+}
+
+void applyAffinity(Data& data, Affinity affinity) {
+    bool isNumber = data.type != DataType::TypeNull && data.type != DataType::TypeText &&
+                    data.type != DataType::TypeBlob && data.type != DataType::Unsupported;
+    switch (affinity) {
+        case Affinity::Text:
+            if (isNumber) {
+                std::ostringstream ss;
+                printData(ss, data);
+                data.type = DataType::TypeText;
+                data.value.text = strdup(ss.str().c_str());
+            }
+            break;
+        case Affinity::Integer:
+        case Affinity::Numeric:
+        case Affinity::Real:
+            if (data.type == DataType::TypeText) {
+                Data number;
+                if (parseNumeric(data.value.text, number)) {
+                    free(data.value.text);
+                    data = number;
+                }
+            }
+            // a REAL column stores integral values as integers on disk
+            if (affinity == Affinity::Real && data.type != DataType::TypeFloat64 &&
+                data.type != DataType::TypeText && data.type != DataType::TypeBlob && data.type != DataType::TypeNull) {
+                data.value = DataUnion(static_cast<double>(getIntegerValue(data)));
+                data.type = DataType::TypeFloat64;
+            }
+            break;
+        case Affinity::Blob:
+            break;
     }
 }
 
@@ -166,19 +471,47 @@ SQLiteEncoding getTextEncoding(std::istream& stream) {
     return static_cast<SQLiteEncoding>(encodingType);
 }
 
-void readText(char* text, size_t nBytes, SQLiteEncoding textEncoding, std::istream& stream) {
+size_t readText(char* text, size_t nBytes, SQLiteEncoding textEncoding, std::istream& stream) {
     switch(textEncoding) {
         // UTF-8 is a variable-width encoding where each character can range from 1 to 4 bytes
         case SQLiteEncoding::SQLITE_UTF8: {
             stream.read(text, nBytes);
             //TODO: handle failure | character boundaries
-            break;
-        }
-        case SQLiteEncoding::SQLITE_UTF16BE: {
-            break;
+            return nBytes;
         }
+        // UTF-16 text is converted to UTF-8 so the rest of the code only ever sees one encoding
+        case SQLiteEncoding::SQLITE_UTF16BE:
         case SQLiteEncoding::SQLITE_UTF16LE: {
-            break;
+            std::string raw(nBytes, '\0');
+            stream.read(&raw[0], nBytes);
+            bool bigEndian = textEncoding == SQLiteEncoding::SQLITE_UTF16BE;
+            size_t length = 0;
+            for (size_t i = 0; i + 1 < nBytes; i += 2) {
+                unsigned char hi = raw[i + (bigEndian ? 0 : 1)], lo = raw[i + (bigEndian ? 1 : 0)];
+                uint32_t codePoint = (hi << 8) | lo;
+                // surrogate pair | 4 bytes in, 4 bytes out
+                if (codePoint >= 0xD800 && codePoint < 0xDC00 && i + 3 < nBytes) {
+                    unsigned char hi2 = raw[i + (bigEndian ? 2 : 3)], lo2 = raw[i + (bigEndian ? 3 : 2)];
+                    codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (((hi2 << 8) | lo2) - 0xDC00);
+                    i += 2;
+                }
+                if (codePoint < 0x80) {
+                    text[length++] = codePoint;
+                } else if (codePoint < 0x800) {
+                    text[length++] = 0xC0 | (codePoint >> 6);
+                    text[length++] = 0x80 | (codePoint & 0x3F);
+                } else if (codePoint < 0x10000) {
+                    text[length++] = 0xE0 | (codePoint >> 12);
+                    text[length++] = 0x80 | ((codePoint >> 6) & 0x3F);
+                    text[length++] = 0x80 | (codePoint & 0x3F);
+                } else {
+                    text[length++] = 0xF0 | (codePoint >> 18);
+                    text[length++] = 0x80 | ((codePoint >> 12) & 0x3F);
+                    text[length++] = 0x80 | ((codePoint >> 6) & 0x3F);
+                    text[length++] = 0x80 | (codePoint & 0x3F);
+                }
+            }
+            return length;
         }
         default:
             throw std::runtime_error("Invalid Text Encoding!! Unable to proceed");
@@ -233,4 +566,55 @@ void splitString(const std::string& str, char delimiter, DynamicArray& tokens) {
     while (std::getline(ss, token, delimiter)) {
         tokens.add(token);
     }
-}
\ No newline at end of file
+}
+
+void tokenizeSql(const std::string& sql, DynamicArray& tokens) {
+    size_t i = 0;
+    while (i < sql.size()) {
+        char c = sql[i];
+        if (isspace(static_cast<unsigned char>(c))) {
+            i++;
+        }
+        else if (c == '(' || c == ')' || c == ',' || c == ';' || c == '=' || c == '*') {
+            tokens.add(std::string(1, c));
+            i++;
+        }
+        else if (c == '\'') {
+            // string literal | keeps its quotes, '' is an escaped quote
+            std::string token = "'";
+            i++;
+            while (i < sql.size()) {
+                if (sql[i] == '\'') {
+                    if (i + 1 < sql.size() && sql[i + 1] == '\'') { token += '\''; i += 2; continue; }
+                    i++;
+                    break;
+                }
+                token += sql[i++];
+            }
+            tokens.add(token + "'");
+        }
+        else if (c == '"' || c == '`' || c == '[') {
+            char close = c == '[' ? ']' : c;
+            size_t end = sql.find(close, i + 1);
+            if (end == std::string::npos) end = sql.size();
+            tokens.add(sql.substr(i + 1, end - i - 1));
+            i = end + 1;
+        }
+        else {
+            size_t start = i;
+            while (i < sql.size() && !isspace(static_cast<unsigned char>(sql[i])) &&
+                   std::string("(),;=*'\"`[").find(sql[i]) == std::string::npos) {
+                i++;
+            }
+            tokens.add(sql.substr(start, i - start));
+        }
+    }
+}
+
+bool equalsIgnoreCase(const std::string& a, const std::string& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (tolower(static_cast<unsigned char>(a[i])) != tolower(static_cast<unsigned char>(b[i]))) return false;
+    }
+    return true;
+}
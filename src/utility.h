@@ -4,7 +4,10 @@
 #include <stdexcept>
 #include <string>
 #include <cstdint>
+#include <istream>
+#include <ostream>
 #define varint int64_t
+#define MAX_RECORD_COLUMNS 128
 
 typedef enum {
     SQLITE_UTF8 = 1,     // UTF-8 text encoding
@@ -12,6 +15,15 @@ typedef enum {
     SQLITE_UTF16BE = 3   // UTF-16 big-endian text encoding
 } SQLiteEncoding;
 
+// type affinity of a column, from its declared type
+enum class Affinity {
+    Text,
+    Numeric,
+    Integer,
+    Real,
+    Blob
+};
+
 // Enum representing data types handled by the processor
 enum class DataType {
     TypeNull,
@@ -71,6 +83,36 @@ Data processData(std::istream& stream, DataType type);
 // Function to process data by its serial type code
 Data processBySerialType(varint serialType, std::istream& stream);
 
+// read a `nBytes` wide big-endian signed integer from current read position of `stream`
+int64_t readBigEndianInt(std::istream& stream, int nBytes);
+
+// read a varint from current read position of `stream`
+varint readVarint(std::istream& stream);
+// read a varint from `buffer`, storing the number of bytes consumed in `nBytes`
+varint readVarint(const char* buffer, int* nBytes);
+// read big endian 4 byte int from current read positon of an input stream
+uint32_t read4ByteInt(std::istream& stream);
+// read big endian 2 / 4 byte ints from `buffer`
+unsigned short read2ByteInt(const char* buffer);
+uint32_t read4ByteInt(const char* buffer);
+
+// decode the first `maxColumns` values of a record `payload` into `columns`
+// returns the number of values decoded, which is less than `maxColumns` for short records
+int decodeRecord(const std::string& payload, Data* columns, int maxColumns);
+// release text / blob buffers held by `columns`
+void freeDataColumns(Data* columns, int numColumns);
+
+// integer value of an integer typed `data` | 0 for anything else
+int64_t getIntegerValue(const Data& data);
+// compare two values the way the BINARY collation orders them in an index:
+// NULL < INTEGER/REAL < TEXT < BLOB, text by its bytes in the database encoding | returns <0, 0 or >0
+int compareData(const Data& a, const Data& b);
+// write `data` the way the sqlite3 shell prints a column value
+void printData(std::ostream& out, const Data& data);
+// convert `data` the way a column with `affinity` stores it | numbers become malloc'ed text for TEXT,
+// numeric looking text becomes a number for INTEGER / REAL / NUMERIC and REAL makes integers real
+void applyAffinity(Data& data, Affinity affinity);
+
 
 void initDataTable(DataTable *table);
 void addRow(DataTable *table, Data *rowData, int numColumns);
@@ -78,7 +120,8 @@ void freeDataTable(DataTable *table);
 
 SQLiteEncoding getTextEncoding(std::istream& stream);
 
-void readText(char* text, size_t nBytes, SQLiteEncoding textEncoding, std::istream& stream);
+// read `nBytes` of text stored in `textEncoding` into `text` as UTF-8 | returns the UTF-8 length
+size_t readText(char* text, size_t nBytes, SQLiteEncoding textEncoding, std::istream& stream);
 
 class DynamicArray {
 public:
@@ -98,5 +141,11 @@ private:
 
 void splitString(const std::string& str, char delimiter, DynamicArray& tokens);
 
+// split a SQL statement into tokens: punctuation `(),;=*` stands alone, 'string literals' keep
+// their quotes and "quoted" / `quoted` / [quoted] identifiers are unquoted
+void tokenizeSql(const std::string& sql, DynamicArray& tokens);
+
+bool equalsIgnoreCase(const std::string& a, const std::string& b);
+
 
 #endif // UTILITY_H